@@ -366,6 +366,12 @@ LUA_API int lua_compare (lua_State *L, int index1, int index2, int op) {
 }
 
 
+LUA_API int lua_strcmp (const char *s1, size_t l1,
+                        const char *s2, size_t l2) {
+  return luaV_strcmp(s1, l1, s2, l2);
+}
+
+
 LUA_API unsigned lua_numbertocstring (lua_State *L, int idx, char *buff) {
   const TValue *o = index2value(L, idx);
   if (ttisnumber(o)) {
@@ -567,6 +573,30 @@ LUA_API const char *lua_pushexternalstring (lua_State *L,
 }
 
 
+/*
+** Pushes on the stack the substring of the string at 'idx' with 'len'
+** bytes starting at offset 'i'. Long suffixes share the contents of
+** the original string instead of copying them.
+*/
+LUA_API const char *lua_pushsubstring (lua_State *L, int idx,
+                                       size_t i, size_t len) {
+  TValue *o;
+  TString *ts;
+  lua_lock(L);
+  o = index2value(L, idx);
+  api_check(L, ttisstring(o), "string expected");
+  ts = tsvalue(o);
+  api_check(L, i <= tsslen(ts) && len <= tsslen(ts) - i,
+               "substring out of bounds");
+  ts = luaS_newsub(L, ts, i, len);
+  setsvalue2s(L, L->top.p, ts);
+  api_incr_top(L);
+  luaC_checkGC(L);
+  lua_unlock(L);
+  return getstr(ts);
+}
+
+
 LUA_API const char *lua_pushstring (lua_State *L, const char *s) {
   lua_lock(L);
   if (s == NULL)
@@ -791,11 +821,13 @@ LUA_API int lua_rawgetp (lua_State *L, int idx, const void *p) {
 
 LUA_API void lua_createtable (lua_State *L, int narray, int nrec) {
   Table *t;
+  int small = (narray <= 0 && nrec <= MAXINLINE);  /* a small record? */
   lua_lock(L);
-  t = luaH_new(L);
+  t = small ? luaH_newrecord(L, (nrec > 0) ? cast_uint(nrec) : 0)
+            : luaH_new(L);
   sethvalue2s(L, L->top.p, t);
   api_incr_top(L);
-  if (narray > 0 || nrec > 0)
+  if (!small)
     luaH_resize(L, t, cast_uint(narray), cast_uint(nrec));
   luaC_checkGC(L);
   lua_unlock(L);
@@ -961,6 +993,30 @@ LUA_API void lua_rawseti (lua_State *L, int idx, lua_Integer n) {
 }
 
 
+/*
+** Raw move of 't1[f..e]' into 't2[t..]' done as a block move inside
+** the array parts. Moving inside a single table does not create new
+** references; otherwise, the destination needs a barrier for all the
+** values it got.
+*/
+LUA_API int lua_rawmove (lua_State *L, int idx1, lua_Integer f,
+                         lua_Integer e, lua_Integer t, int idx2) {
+  Table *t1, *t2;
+  int res = 1;  /* empty moves are always done */
+  lua_lock(L);
+  t1 = gettable(L, idx1);
+  t2 = gettable(L, idx2);
+  if (f <= e) {
+    api_check(L, f > 0 || e < LUA_MAXINTEGER + f, "too many elements");
+    res = luaH_movearray(t1, f, e, t2, t);
+    if (res && t1 != t2 && isblack(t2))
+      luaC_barrierback_(L, obj2gco(t2));
+  }
+  lua_unlock(L);
+  return res;
+}
+
+
 LUA_API int lua_setmetatable (lua_State *L, int objindex) {
   TValue *obj;
   Table *mt;
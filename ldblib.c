@@ -420,6 +420,40 @@ static int db_gethook (lua_State *L) {
 }
 
 
+#if defined(LUA_USE_OPCOUNT)
+/*
+** Returns a table with the number of executions of each opcode and a
+** table with the number of executions of each pair of consecutive
+** opcodes (with keys like "GETFIELD CALL"), both only with non-zero
+** counts. With a true argument, also resets all counters.
+*/
+static int db_opcounts (lua_State *L) {
+  int op, next;
+  const char *name, *nextname;
+  lua_Unsigned n;
+  lua_newtable(L);  /* 1st result: counts of opcodes */
+  lua_newtable(L);  /* 2nd result: counts of pairs */
+  for (op = 0; (name = lua_getopcount(L, op, -1, &n)) != NULL; op++) {
+    if (n == 0) continue;  /* opcode never executed */
+    lua_pushinteger(L, (lua_Integer)n);
+    lua_setfield(L, -3, name);
+    for (next = 0; (nextname = lua_getopcount(L, next, -1, &n)) != NULL;
+                   next++) {
+      lua_getopcount(L, op, next, &n);
+      if (n > 0) {
+        lua_pushfstring(L, "%s %s", name, nextname);
+        lua_pushinteger(L, (lua_Integer)n);
+        lua_rawset(L, -3);
+      }
+    }
+  }
+  if (lua_toboolean(L, 1))
+    lua_resetopcounts(L);
+  return 2;
+}
+#endif
+
+
 static int db_debug (lua_State *L) {
   for (;;) {
     char buffer[250];
@@ -458,6 +492,9 @@ static const luaL_Reg dblib[] = {
   {"getregistry", db_getregistry},
   {"getmetatable", db_getmetatable},
   {"getupvalue", db_getupvalue},
+#if defined(LUA_USE_OPCOUNT)
+  {"opcounts", db_opcounts},
+#endif
   {"upvaluejoin", db_upvaluejoin},
   {"upvalueid", db_upvalueid},
   {"setuservalue", db_setuservalue},
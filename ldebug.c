@@ -159,6 +159,46 @@ LUA_API int lua_gethookcount (lua_State *L) {
 }
 
 
+#if defined(LUA_USE_OPCOUNT)
+
+#include "lopnames.h"
+
+void luaG_resetopcounts (global_State *g) {
+  int i, j;
+  for (i = 0; i < NUM_OPCODES; i++) {
+    g->opcount[i] = 0;
+    for (j = 0; j <= NUM_OPCODES; j++)
+      g->oppaircount[j][i] = 0;
+  }
+  g->lastop = NUM_OPCODES;  /* no previous opcode */
+}
+
+
+/*
+** Gets in '*count' how many times opcode 'op' was executed or, if 'next'
+** is a valid opcode, how many times 'next' was executed right after
+** 'op'. Returns the name of 'op', or NULL if it is not a valid opcode.
+*/
+LUA_API const char *lua_getopcount (lua_State *L, int op, int next,
+                                    lua_Unsigned *count) {
+  global_State *g = G(L);
+  if (op < 0 || op >= NUM_OPCODES)
+    return NULL;
+  else if (0 <= next && next < NUM_OPCODES)
+    *count = g->oppaircount[op][next];
+  else
+    *count = g->opcount[op];
+  return opnames[op];
+}
+
+
+LUA_API void lua_resetopcounts (lua_State *L) {
+  luaG_resetopcounts(G(L));
+}
+
+#endif
+
+
 LUA_API int lua_getstack (lua_State *L, int level, lua_Debug *ar) {
   int status;
   CallInfo *ci;
@@ -61,5 +61,9 @@ LUAI_FUNC l_noret luaG_errormsg (lua_State *L);
 LUAI_FUNC int luaG_traceexec (lua_State *L, const Instruction *pc);
 LUAI_FUNC int luaG_tracecall (lua_State *L);
 
+#if defined(LUA_USE_OPCOUNT)
+LUAI_FUNC void luaG_resetopcounts (global_State *g);
+#endif
+
 
 #endif
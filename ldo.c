@@ -628,18 +628,13 @@ void luaD_poscall (lua_State *L, CallInfo *ci, int nres) {
 
 
 /*
-** Allocate and initialize CallInfo structure. At this point, the
-** only valid fields in the call status are number of results,
-** CIST_C (if it's a C function), and number of extra arguments.
-** (All these bit-fields fit in 16-bit values.)
+** Allocate and initialize CallInfo structure (see 'luaD_initci').
+** (All the bit-fields in the call status fit in 16-bit values.)
 */
 l_sinline CallInfo *prepCallInfo (lua_State *L, StkId func, unsigned status,
                                                 StkId top) {
   CallInfo *ci = L->ci = next_ci(L);  /* new frame */
-  ci->func.p = func;
-  lua_assert((status & ~(CIST_NRESULTS | CIST_C | MAX_CCMT)) == 0);
-  ci->callstatus = status;
-  ci->top.p = top;
+  luaD_initci(ci, func, status, top);
   return ci;
 }
 
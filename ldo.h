@@ -53,6 +53,19 @@
     p = restorestack(L, t__))  /* 'pos' part: restore 'p' */
 
 
+/*
+** Initialize a new frame 'ci' for function 'f' with call status 'st'
+** and top 't'. At this point, the only valid fields in the call status
+** are number of results, CIST_C (if it's a C function), and number of
+** extra arguments. (Used by the precalls and by the fast path of
+** OP_CALL in 'luaV_execute'.)
+*/
+#define luaD_initci(ci,f,st,t)  \
+  { CallInfo *ci_ = (ci); ci_->func.p = (f); \
+    lua_assert(((st) & ~(CIST_NRESULTS | CIST_C | MAX_CCMT)) == 0); \
+    ci_->callstatus = (st); ci_->top.p = (t); }
+
+
 /*
 ** Maximum depth for nested C calls, syntactical nested non-terminals,
 ** and other features implemented through recursion in C. (Value must
@@ -249,6 +249,8 @@ Proto *luaF_newproto (lua_State *L) {
   f->sizep = 0;
   f->code = NULL;
   f->sizecode = 0;
+  f->icache = NULL;
+  f->sizeicache = 0;
   f->lineinfo = NULL;
   f->sizelineinfo = 0;
   f->abslineinfo = NULL;
@@ -267,12 +269,29 @@ Proto *luaF_newproto (lua_State *L) {
 }
 
 
+/*
+** Create the inline caches for a prototype, one for each instruction.
+** Only some instructions use their caches (see 'luaV_execute'); each
+** cache is only a hint, so any initial value is valid. (Prototypes
+** loaded from fixed buffers have no caches, to keep them small.)
+*/
+void luaF_newicache (lua_State *L, Proto *f) {
+  int i;
+  int n = f->sizecode;
+  f->icache = luaM_newvectorchecked(L, n, unsigned);
+  f->sizeicache = n;
+  for (i = 0; i < n; i++)
+    f->icache[i] = 0;
+}
+
+
 lu_mem luaF_protosize (Proto *p) {
   lu_mem sz = cast(lu_mem, sizeof(Proto))
             + cast_uint(p->sizep) * sizeof(Proto*)
             + cast_uint(p->sizek) * sizeof(TValue)
             + cast_uint(p->sizelocvars) * sizeof(LocVar)
-            + cast_uint(p->sizeupvalues) * sizeof(Upvaldesc);
+            + cast_uint(p->sizeupvalues) * sizeof(Upvaldesc)
+            + cast_uint(p->sizeicache) * sizeof(unsigned);
   if (!(p->flag & PF_FIXED)) {
     sz += cast_uint(p->sizecode) * sizeof(Instruction);
     sz += cast_uint(p->sizelineinfo) * sizeof(lu_byte);
@@ -288,6 +307,7 @@ void luaF_freeproto (lua_State *L, Proto *f) {
     luaM_freearray(L, f->lineinfo, cast_sizet(f->sizelineinfo));
     luaM_freearray(L, f->abslineinfo, cast_sizet(f->sizeabslineinfo));
   }
+  luaM_freearray(L, f->icache, cast_sizet(f->sizeicache));
   luaM_freearray(L, f->p, cast_sizet(f->sizep));
   luaM_freearray(L, f->k, cast_sizet(f->sizek));
   luaM_freearray(L, f->locvars, cast_sizet(f->sizelocvars));
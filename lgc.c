@@ -331,19 +331,26 @@ GCObject *luaC_newobj (lua_State *L, lu_byte tt, size_t sz) {
 ** 'twups' list, so they don't go to the gray list; nevertheless, they
 ** are kept gray to avoid barriers, as their values will be revisited
 ** by the thread or by 'remarkupvals'.  Other objects are added to the
-** gray list to be visited (and turned black) later.  Both userdata and
-** upvalues can call this function recursively, but this recursion goes
-** for at most two levels: An upvalue cannot refer to another upvalue
-** (only closures can), and a userdata's metatable must be a table.
+** gray list to be visited (and turned black) later.  Userdata, upvalues,
+** and string views can call this function recursively, but this
+** recursion goes for at most two levels: An upvalue cannot refer to
+** another upvalue (only closures can), a userdata's metatable must be
+** a table, and the parent of a view is never a view.
 */
 static void reallymarkobject (global_State *g, GCObject *o) {
   g->GCmarked += objsize(o);
   switch (o->tt) {
-    case LUA_VSHRSTR:
-    case LUA_VLNGSTR: {
+    case LUA_VSHRSTR: {
       set2black(o);  /* nothing to visit */
       break;
     }
+    case LUA_VLNGSTR: {
+      TString *ts = gco2ts(o);
+      set2black(ts);
+      if (ts->shrlen == LSTRVIEW)  /* a view? */
+        markobject(g, strparent(ts));  /* keep its contents alive */
+      break;
+    }
     case LUA_VUPVAL: {
       UpVal *uv = gco2upv(o);
       if (upisopen(uv))
@@ -509,13 +516,13 @@ static void traverseweakvalue (global_State *g, Table *h) {
 
 
 /*
-** Traverse the array part of a table.
+** Mark the collectable values in the slice [i, lim) of the array part
+** of a table.
 */
-static int traversearray (global_State *g, Table *h) {
-  unsigned asize = h->asize;
-  int marked = 0;  /* true if some object is marked in this traversal */
-  unsigned i;
-  for (i = 0; i < asize; i++) {
+static int markarrayslice (global_State *g, Table *h, unsigned i,
+                                                      unsigned lim) {
+  int marked = 0;  /* true if some object is marked in this slice */
+  for (; i < lim; i++) {
     GCObject *o = gcvalarr(h, i);
     if (o != NULL && iswhite(o)) {
       marked = 1;
@@ -526,6 +533,29 @@ static int traversearray (global_State *g, Table *h) {
 }
 
 
+/* 'BIT_ISCOLLECTABLE' replicated in all bytes of a 'size_t' */
+#define COLLECTABLEBYTES	((~cast_sizet(0) / 0xff) * BIT_ISCOLLECTABLE)
+
+/*
+** Traverse the array part of a table. The tags are checked a word at
+** a time, so that runs of non-collectable values (e.g., numbers) are
+** skipped without looking at each value.
+*/
+static int traversearray (global_State *g, Table *h) {
+  unsigned asize = h->asize;
+  const lu_byte *tags = getArrTag(h, 0);
+  int marked = 0;  /* true if some object is marked in this traversal */
+  unsigned i;
+  for (i = 0; asize - i >= sizeof(size_t); i += sizeof(size_t)) {
+    size_t w;
+    memcpy(&w, tags + i, sizeof(w));  /* tags may be unaligned */
+    if (w & COLLECTABLEBYTES)  /* some collectable value in this word? */
+      marked |= markarrayslice(g, h, i, i + cast_uint(sizeof(size_t)));
+  }
+  return marked | markarrayslice(g, h, i, asize);
+}
+
+
 /*
 ** Traverse an ephemeron table and link it to proper list. Returns true
 ** iff any object was marked during this traversal (which implies that
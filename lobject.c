@@ -51,6 +51,19 @@ lu_byte luaO_ceillog2 (unsigned int x) {
   return cast_byte(l + log_2[x]);
 }
 
+/*
+** Computes the smallest size code (see 'nodesize') for a hash part
+** with at least 'x' slots.
+*/
+lu_byte luaO_sizecode (unsigned int x) {
+  int l = luaO_ceillog2(x);  /* 2^(l - 1) < x <= 2^l */
+  if (l >= 2 && x <= (3u << (l - 2)))  /* x <= 1.5 * 2^(l - 1)? */
+    return cast_byte(2 * l - 1);
+  else
+    return cast_byte(2 * l);
+}
+
+
 /*
 ** Encodes 'p'% as a floating-point byte, represented as (eeeexxxx).
 ** The exponent is represented using excess-7. Mimicking IEEE 754, the
@@ -398,6 +398,7 @@ typedef struct GCObject {
 #define LSTRREG		-1  /* regular long string */
 #define LSTRFIX		-2  /* fixed external long string */
 #define LSTRMEM		-3  /* external long string with deallocation */
+#define LSTRVIEW	-4  /* suffix of another long string */
 
 
 /*
@@ -414,13 +415,17 @@ typedef struct TString {
   } u;
   char *contents;  /* pointer to content in long strings */
   lua_Alloc falloc;  /* deallocation function for external strings */
-  void *ud;  /* user data for external strings */
+  void *ud;  /* user data for external strings; parent for views */
 } TString;
 
 
 #define strisshr(ts)	((ts)->shrlen >= 0)
 #define isextstr(ts)	(ttislngstring(ts) && tsvalue(ts)->shrlen != LSTRREG)
 
+/* string whose contents a view points into */
+#define strparent(ts)	check_exp((ts)->shrlen == LSTRVIEW, \
+                                  cast(TString *, (ts)->ud))
+
 
 /*
 ** Get the actual string (array of bytes) from a 'TString'. (Generic
@@ -612,10 +617,12 @@ typedef struct Proto {
   int sizep;  /* size of 'p' */
   int sizelocvars;
   int sizeabslineinfo;  /* size of 'abslineinfo' */
+  int sizeicache;  /* size of 'icache' */
   int linedefined;  /* debug information  */
   int lastlinedefined;  /* debug information  */
   TValue *k;  /* constants used by the function */
   Instruction *code;  /* opcodes */
+  unsigned *icache;  /* inline caches for instructions (indexed by pc) */
   struct Proto **p;  /* functions defined inside the function */
   Upvaldesc *upvalues;  /* upvalue information */
   ls_byte *lineinfo;  /* information about source lines (debug information) */
@@ -777,7 +784,7 @@ typedef union Node {
 typedef struct Table {
   CommonHeader;
   lu_byte flags;  /* 1<<p means tagmethod(p) is not present */
-  lu_byte lsizenode;  /* log2 of number of slots of 'node' array */
+  lu_byte lsizenode;  /* size code for 'node' array (see 'sizenode') */
   unsigned int asize;  /* number of slots in 'array' array */
   Value *array;  /* array part */
   Node *node;
@@ -827,7 +834,15 @@ typedef struct Table {
 
 
 #define twoto(x)	(1u<<(x))
-#define sizenode(t)	(twoto((t)->lsizenode))
+
+/*
+** Sizes of hash parts are either powers of 2 or 1.5 times powers of 2,
+** so that growing a table wastes less memory. A size code is twice the
+** integer log2 of the size, plus 1 in the second case. (Code 1 is not
+** used.)
+*/
+#define nodesize(c)	((cast_uint(2 | ((c) & 1)) << ((c) >> 1)) >> 1)
+#define sizenode(t)	nodesize((t)->lsizenode)
 
 
 /* size of buffer for 'luaO_utf8esc' function */
@@ -844,6 +859,7 @@ typedef struct Table {
 
 LUAI_FUNC int luaO_utf8esc (char *buff, l_uint32 x);
 LUAI_FUNC lu_byte luaO_ceillog2 (unsigned int x);
+LUAI_FUNC lu_byte luaO_sizecode (unsigned int x);
 LUAI_FUNC lu_byte luaO_codeparam (unsigned int p);
 LUAI_FUNC l_mem luaO_applyparam (lu_byte p, l_mem x);
 
@@ -383,8 +383,8 @@ OP_EXTRAARG/*	Ax	extra (larger) argument for previous opcode	*/
   real C = EXTRAARG _ C (the bits of EXTRAARG concatenated with the
   bits of C).
 
-  (*) In OP_NEWTABLE, vB is log2 of the hash size (which is always a
-  power of 2) plus 1, or zero for size zero. If not k, the array size
+  (*) In OP_NEWTABLE, vB is the size code of the hash size (see
+  'nodesize') plus 1, or zero for size zero. If not k, the array size
   is vC. Otherwise, the array size is EXTRAARG _ vC.
 
   (*) In OP_ERRNNIL, (Bx == 0) means index of global name doesn't
@@ -18,6 +18,10 @@ typedef struct CallInfo CallInfo;
 #include "ltm.h"
 #include "lzio.h"
 
+#if defined(LUA_USE_OPCOUNT)
+#include "lopcodes.h"
+#endif
+
 
 /*
 ** Some notes about garbage-collected objects: All objects in Lua must
@@ -335,6 +339,7 @@ typedef struct global_State {
   TValue l_registry;
   TValue nilvalue;  /* a nil value */
   unsigned int seed;  /* randomized seed for hashes */
+  unsigned int nexthint;  /* node index of the last key returned by 'next' */
   lu_byte gcparams[LUA_GCPN];
   lu_byte currentwhite;
   lu_byte gcstate;  /* state of garbage collector */
@@ -368,6 +373,12 @@ typedef struct global_State {
   TString *strcache[STRCACHE_N][STRCACHE_M];  /* cache for strings in API */
   lua_WarnFunction warnf;  /* warning function */
   void *ud_warn;         /* auxiliary data to 'warnf' */
+#if defined(LUA_USE_OPCOUNT)
+  lua_Unsigned opcount[NUM_OPCODES];  /* executions of each opcode */
+  /* executions of each opcode pair (last row is for "no previous op") */
+  lua_Unsigned oppaircount[NUM_OPCODES + 1][NUM_OPCODES];
+  int lastop;  /* last opcode executed */
+#endif
   LX mainth;  /* main thread of this state */
 } global_State;
 
@@ -38,6 +38,15 @@
 #endif
 
 
+/*
+** Minimum length for a substring to be a view into its parent
+** (must be larger than LUAI_MAXSHORTLEN).
+*/
+#if !defined(MINSTRVIEW)
+#define MINSTRVIEW	256
+#endif
+
+
 /*
 ** generic equality for strings
 */
@@ -50,6 +59,8 @@ int luaS_eqstr (TString *a, TString *b) {
 }
 
 
+#if !defined(LUA_USE_WORDHASH)
+
 static unsigned luaS_hash (const char *str, size_t l, unsigned seed) {
   unsigned int h = seed ^ cast_uint(l);
   for (; l > 0; l--)
@@ -57,6 +68,40 @@ static unsigned luaS_hash (const char *str, size_t l, unsigned seed) {
   return h;
 }
 
+#else
+
+/*
+** Word-at-a-time hash: each word of the string (read with 'memcpy', so
+** it needs no alignment) is mixed into the state with a multiplication
+** by an odd constant (64-bit golden ratio, or its lower half for 32-bit
+** words), followed by a shift that brings high bits down. The last
+** partial word is padded with zeros; the length is mixed in at the
+** start, so that padding cannot create collisions.
+*/
+#define HWORD		size_t
+#define HMUL		((cast(HWORD, 0x9E3779B9u) << 16 << 16) | 0x7F4A7C15u)
+#define hmix(h)		((h) *= HMUL, (h) ^= (h) >> (sizeof(HWORD) * 4))
+
+static unsigned luaS_hash (const char *str, size_t l, unsigned seed) {
+  HWORD h = cast(HWORD, seed) ^ cast(HWORD, l) ^ HMUL;
+  HWORD w;
+  for (; l >= sizeof(HWORD); l -= sizeof(HWORD), str += sizeof(HWORD)) {
+    memcpy(&w, str, sizeof(HWORD));
+    h ^= w;
+    hmix(h);
+  }
+  if (l > 0) {  /* partial last word? */
+    w = 0;
+    memcpy(&w, str, l);
+    h ^= w;
+    hmix(h);
+  }
+  hmix(h);  /* final avalanche */
+  return cast_uint(h ^ (h >> (sizeof(HWORD) * 4)));
+}
+
+#endif
+
 
 unsigned luaS_hashlongstr (TString *ts) {
   lua_assert(ts->tt == LUA_VLNGSTR);
@@ -154,8 +199,8 @@ size_t luaS_sizelngstr (size_t len, int kind) {
     case LSTRFIX:  /* fixed external long string */
       /* don't need 'falloc'/'ud' */
       return offsetof(TString, falloc);
-    default:  /* external long string with deallocation */
-      lua_assert(kind == LSTRMEM);
+    default:  /* external long string with deallocation or view */
+      lua_assert(kind == LSTRMEM || kind == LSTRVIEW);
       return sizeof(TString);
   }
 }
@@ -351,3 +396,34 @@ TString *luaS_normstr (lua_State *L, TString *ts) {
   }
 }
 
+
+/*
+** Create a string with the 'l' bytes of 'ts' starting at offset 'i'.
+** A long suffix of a long string becomes a view into the contents of
+** its parent, which already end with the '\0' every string needs. A
+** view keeps its parent alive, so it is created only when it is not
+** much shorter than that parent; otherwise the bytes are copied.
+** Views always point to the original string, never to other views.
+*/
+TString *luaS_newsub (lua_State *L, TString *ts, size_t i, size_t l) {
+  size_t len;
+  const char *s = getlstr(ts, len);
+  lua_assert(i <= len && l <= len - i);
+  if (i == 0 && l == len)
+    return ts;  /* whole string */
+  else if (i + l == len && l >= MINSTRVIEW) {  /* long suffix? */
+    TString *p = (ts->shrlen == LSTRVIEW) ? strparent(ts) : ts;
+    if (l >= p->u.lnglen / 4) {  /* not too short for its parent? */
+      TString *view = createstrobj(L, luaS_sizelngstr(0, LSTRVIEW),
+                                      LUA_VLNGSTR, G(L)->seed);
+      view->shrlen = LSTRVIEW;
+      view->u.lnglen = l;
+      view->contents = cast_charp(s + i);
+      view->falloc = NULL;
+      view->ud = p;
+      return view;
+    }
+  }
+  return luaS_newlstr(L, s + i, l);
+}
+
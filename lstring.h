@@ -69,5 +69,7 @@ LUAI_FUNC TString *luaS_newextlstr (lua_State *L,
 		const char *s, size_t len, lua_Alloc falloc, void *ud);
 LUAI_FUNC size_t luaS_sizelngstr (size_t len, int kind);
 LUAI_FUNC TString *luaS_normstr (lua_State *L, TString *ts);
+LUAI_FUNC TString *luaS_newsub (lua_State *L, TString *ts,
+                                              size_t i, size_t l);
 
 #endif
@@ -84,11 +84,12 @@ static size_t getendpos (lua_State *L, int arg, lua_Integer def,
 
 static int str_sub (lua_State *L) {
   size_t l;
-  const char *s = luaL_checklstring(L, 1, &l);
-  size_t start = posrelatI(luaL_checkinteger(L, 2), l);
-  size_t end = getendpos(L, 3, -1, l);
+  size_t start, end;
+  luaL_checklstring(L, 1, &l);
+  start = posrelatI(luaL_checkinteger(L, 2), l);
+  end = getendpos(L, 3, -1, l);
   if (start <= end)
-    lua_pushlstring(L, s + start - 1, (end - start) + 1);
+    lua_pushsubstring(L, 1, start - 1, (end - start) + 1);
   else lua_pushliteral(L, "");
   return 1;
 }
@@ -357,13 +358,24 @@ static const luaL_Reg stringmetamethods[] = {
 #define CAP_POSITION	(-2)
 
 
+/* size of a set of characters */
+#define CHARSETSIZE	((UCHAR_MAX / CHAR_BIT) + 1)
+
+/* values for 'first' (besides a single character) */
+#define FIRSTANY	(-1)  /* any character can start a match */
+#define FIRSTSET	(-2)  /* only characters in 'firstset' can */
+
+
 typedef struct MatchState {
   const char *src_init;  /* init of source string */
   const char *src_end;  /* end ('\0') of source string */
   const char *p_end;  /* end ('\0') of pattern */
   lua_State *L;
+  int src;  /* index of source string (for captures) */
   int matchdepth;  /* control for recursive depth (to avoid C stack overflow) */
   int level;  /* total number of captures (finished or unfinished) */
+  int first;  /* only character that can start a match, or FIRST* */
+  unsigned char firstset[CHARSETSIZE];  /* characters for FIRSTSET */
   struct {
     const char *init;
     ptrdiff_t len;  /* length or special value (CAP_*) */
@@ -469,19 +481,25 @@ static int matchbracketclass (int c, const char *p, const char *ec) {
 }
 
 
+/*
+** Check whether char 'c' matches the single-char class in [p, ep).
+*/
+static int classmatch (int c, const char *p, const char *ep) {
+  switch (*p) {
+    case '.': return 1;  /* matches any char */
+    case L_ESC: return match_class(c, cast_uchar(*(p+1)));
+    case '[': return matchbracketclass(c, p, ep-1);
+    default:  return (cast_uchar(*p) == c);
+  }
+}
+
+
 static int singlematch (MatchState *ms, const char *s, const char *p,
                         const char *ep) {
   if (s >= ms->src_end)
     return 0;
-  else {
-    int c = cast_uchar(*s);
-    switch (*p) {
-      case '.': return 1;  /* matches any char */
-      case L_ESC: return match_class(c, cast_uchar(*(p+1)));
-      case '[': return matchbracketclass(c, p, ep-1);
-      default:  return (cast_uchar(*p) == c);
-    }
-  }
+  else
+    return classmatch(cast_uchar(*s), p, ep);
 }
 
 
@@ -730,7 +748,8 @@ static void push_onecapture (MatchState *ms, int i, const char *s,
   const char *cap;
   ptrdiff_t l = get_onecapture(ms, i, s, e, &cap);
   if (l != CAP_POSITION)
-    lua_pushlstring(ms->L, cap, cast_sizet(l));
+    lua_pushsubstring(ms->L, ms->src, ct_diff2sz(cap - ms->src_init),
+                                      cast_sizet(l));
   /* else position was already pushed */
 }
 
@@ -760,9 +779,10 @@ static int nospecials (const char *p, size_t l) {
 /*
 ** Prepare state for matches. These fields are not affected by each match.
 */
-static void prepstate (MatchState *ms, lua_State *L,
+static void prepstate (MatchState *ms, lua_State *L, int src,
                        const char *s, size_t ls, const char *p, size_t lp) {
   ms->L = L;
+  ms->src = src;
   ms->src_init = s;
   ms->src_end = s + ls;
   ms->p_end = p + lp;
@@ -779,6 +799,196 @@ static void reprepstate (MatchState *ms) {
 }
 
 
+/* number of patterns whose first characters are cached */
+#if !defined(PATCACHE_N)
+#define PATCACHE_N	8
+#endif
+
+
+#define firstbit(c)	cast_uchar(1u << ((c) % CHAR_BIT))
+#define setfirst(ms,c)	((ms)->firstset[(c) / CHAR_BIT] = \
+          cast_uchar((ms)->firstset[(c) / CHAR_BIT] | firstbit(c)))
+#define isfirst(ms,c)	((ms)->firstset[(c) / CHAR_BIT] & firstbit(c))
+
+
+typedef struct PatInfo {
+  const char *p;  /* pattern (NULL for empty entries) */
+  size_t lp;  /* length of the pattern */
+  unsigned int stamp;  /* time of last use */
+  int first;  /* copy of 'MatchState' fields */
+  unsigned char firstset[CHARSETSIZE];
+} PatInfo;
+
+
+/*
+** Cache for the first characters of recently used patterns, kept as
+** an upvalue of the pattern-matching functions. The user values of
+** this userdata anchor the patterns in the cache.
+*/
+typedef struct PatCache {
+  unsigned int clock;  /* time of last access */
+  PatInfo e[PATCACHE_N];
+} PatCache;
+
+
+/*
+** Check whether a single-char class uses a locale-dependent class
+** ('%a', '%d', etc.). The result of those for non-ASCII characters
+** can change with the locale, so it cannot be cached.
+*/
+static int localedep (const char *p, const char *ep) {
+  for (; p < ep; p++) {
+    if (*p == L_ESC && isalpha(cast_uchar(*(p + 1))))
+      return 1;
+  }
+  return 0;
+}
+
+
+/*
+** Find the first single-char class in pattern 'p' (after opening
+** captures), when it must match at least once. Return that class if
+** the set of characters that can start a match must be computed from
+** it; otherwise, set 'ms->first' and return NULL. Any character can
+** start a match when there is no such class or the pattern is
+** malformed there ('match' will raise the error). A literal character
+** or a '%b' needs no set either.
+*/
+static const char *firstclass (MatchState *ms, const char *p) {
+  const char *ep;
+  ms->first = FIRSTANY;
+  while (p < ms->p_end && *p == '(')  /* skip opening captures */
+    p += (*(p + 1) == ')') ? 2 : 1;
+  if (p >= ms->p_end)
+    return NULL;  /* pattern can match the empty string */
+  switch (*p) {
+    case ')': return NULL;
+    case '$': {
+      if (p + 1 == ms->p_end) return NULL;  /* end anchor */
+      break;
+    }
+    case L_ESC: {
+      if (p + 1 == ms->p_end)
+        return NULL;  /* malformed */
+      else if (*(p + 1) == 'b') {
+        if (p + 3 < ms->p_end)  /* has both arguments? */
+          ms->first = cast_uchar(*(p + 2));
+        return NULL;
+      }
+      else if (*(p + 1) == 'f' || isdigit(cast_uchar(*(p + 1))))
+        return NULL;  /* frontier or back reference */
+      break;
+    }
+    case '[': {  /* check it is well formed, like 'classend' */
+      const char *q = p + 1;
+      if (*q == '^') q++;
+      do {
+        if (q == ms->p_end) return NULL;  /* malformed */
+        if (*(q++) == L_ESC && q < ms->p_end)
+          q++;
+      } while (*q != ']');
+      break;
+    }
+    default: break;
+  }
+  ep = classend(ms, p);
+  if (*ep == '*' || *ep == '?' || *ep == '-' || *p == '.')
+    return NULL;  /* class may not occur, or matches anything */
+  else if (*p == L_ESC && !isalnum(cast_uchar(*(p + 1)))) {
+    ms->first = cast_uchar(*(p + 1));  /* escaped literal */
+    return NULL;
+  }
+  else if (*p != L_ESC && *p != '[') {
+    ms->first = cast_uchar(*p);  /* literal */
+    return NULL;
+  }
+  else
+    return p;
+}
+
+
+/*
+** Compute which characters can start a match for a pattern whose
+** first class, as found by 'firstclass', starts at 'p'.
+*/
+static void firstchars (MatchState *ms, const char *p) {
+  const char *ep = classend(ms, p);
+  int c, n = 0;
+  int ld = localedep(p, ep);
+  memset(ms->firstset, 0, CHARSETSIZE);
+  for (c = 0; c <= UCHAR_MAX; c++) {
+    if (classmatch(c, p, ep) || (c > 0x7F && ld)) {
+      setfirst(ms, c);
+      ms->first = c;
+      n++;
+    }
+  }
+  if (n == UCHAR_MAX + 1)
+    ms->first = FIRSTANY;
+  else if (n != 1)  /* not a single character? */
+    ms->first = FIRSTSET;
+}
+
+
+/*
+** Set in 'ms' the first characters for pattern 'p' (at index 2).
+** Only patterns that start with a class need a set; those go through
+** the cache. Entries are found by the address of the pattern, which
+** cannot be reused while the pattern is anchored by the cache.
+*/
+static void getfirstchars (MatchState *ms, const char *p, size_t lp) {
+  lua_State *L = ms->L;
+  PatCache *pc;
+  PatInfo *pi;
+  int i;
+  const char *cl = firstclass(ms, p);
+  if (cl == NULL)  /* no set needed? */
+    return;
+  pc = (PatCache *)lua_touserdata(L, lua_upvalueindex(1));
+  pi = &pc->e[0];
+  for (i = 0; i < PATCACHE_N; i++) {
+    PatInfo *e = &pc->e[i];
+    if (e->p == p && e->lp == lp) {  /* hit? */
+      e->stamp = ++pc->clock;
+      ms->first = e->first;
+      memcpy(ms->firstset, e->firstset, CHARSETSIZE);
+      return;
+    }
+    else if (e->stamp < pi->stamp)
+      pi = e;  /* least recently used so far */
+  }
+  firstchars(ms, cl);
+  pi->p = p;  /* replace least recently used entry */
+  pi->lp = lp;
+  pi->stamp = ++pc->clock;
+  pi->first = ms->first;
+  memcpy(pi->firstset, ms->firstset, CHARSETSIZE);
+  lua_pushvalue(L, 2);  /* anchor pattern */
+  lua_setiuservalue(L, lua_upvalueindex(1), cast_int(pi - pc->e) + 1);
+}
+
+
+/*
+** Return the first position from 's' on where a match can start, or
+** NULL if there is none. (Matches restricted by 'first' are never
+** empty, so they cannot start at the end of the subject.)
+*/
+static const char *nextstart (MatchState *ms, const char *s) {
+  if (ms->first == FIRSTANY)
+    return s;
+  else if (ms->first >= 0)  /* a single character? */
+    return (const char *)memchr(s, ms->first,
+                                ct_diff2sz(ms->src_end - s));
+  else {
+    for (; s < ms->src_end; s++) {
+      if (isfirst(ms, cast_uchar(*s)))
+        return s;
+    }
+    return NULL;
+  }
+}
+
+
 static int str_find_aux (lua_State *L, int find) {
   size_t ls, lp;
   const char *s = luaL_checklstring(L, 1, &ls);
@@ -805,9 +1015,15 @@ static int str_find_aux (lua_State *L, int find) {
     if (anchor) {
       p++; lp--;  /* skip anchor character */
     }
-    prepstate(&ms, L, s, ls, p, lp);
+    prepstate(&ms, L, 1, s, ls, p, lp);
+    if (anchor)
+      ms.first = FIRSTANY;
+    else
+      getfirstchars(&ms, p, lp);
     do {
       const char *res;
+      if ((s1 = nextstart(&ms, s1)) == NULL)
+        break;  /* no more possible matches */
       reprepstate(&ms);
       if ((res=match(&ms, s1, p)) != NULL) {
         if (find) {
@@ -850,6 +1066,8 @@ static int gmatch_aux (lua_State *L) {
   gm->ms.L = L;
   for (src = gm->src; src <= gm->ms.src_end; src++) {
     const char *e;
+    if ((src = nextstart(&gm->ms, src)) == NULL)
+      break;  /* no more possible matches */
     reprepstate(&gm->ms);
     if ((e = match(&gm->ms, src, gm->p)) != NULL && e != gm->lastmatch) {
       gm->src = gm->lastmatch = e;
@@ -870,7 +1088,8 @@ static int gmatch (lua_State *L) {
   gm = (GMatchState *)lua_newuserdatauv(L, sizeof(GMatchState), 0);
   if (init > ls)  /* start after string's end? */
     init = ls + 1;  /* avoid overflows in 's + init' */
-  prepstate(&gm->ms, L, s, ls, p, lp);
+  prepstate(&gm->ms, L, lua_upvalueindex(1), s, ls, p, lp);
+  getfirstchars(&gm->ms, p, lp);
   gm->src = s + init; gm->p = p; gm->lastmatch = NULL;
   lua_pushcclosure(L, gmatch_aux, 3);
   return 1;
@@ -968,9 +1187,18 @@ static int str_gsub (lua_State *L) {
   if (anchor) {
     p++; lp--;  /* skip anchor character */
   }
-  prepstate(&ms, L, src, srcl, p, lp);
+  prepstate(&ms, L, 1, src, srcl, p, lp);
+  if (anchor)
+    ms.first = FIRSTANY;
+  else
+    getfirstchars(&ms, p, lp);
   while (n < max_s) {
     const char *e;
+    const char *s1 = nextstart(&ms, src);
+    if (s1 == NULL)
+      break;  /* no more possible matches */
+    luaL_addlstring(&b, src, ct_diff2sz(s1 - src));  /* keep skipped text */
+    src = s1;
     reprepstate(&ms);  /* (re)prepare state for new match */
     if ((e = match(&ms, src, p)) != NULL && e != lastmatch) {  /* match? */
       n++;
@@ -1857,13 +2085,13 @@ static const luaL_Reg strlib[] = {
   {"byte", str_byte},
   {"char", str_char},
   {"dump", str_dump},
-  {"find", str_find},
+  {"find", NULL},
   {"format", str_format},
-  {"gmatch", gmatch},
-  {"gsub", str_gsub},
+  {"gmatch", NULL},
+  {"gsub", NULL},
   {"len", str_len},
   {"lower", str_lower},
-  {"match", str_match},
+  {"match", NULL},
   {"rep", str_rep},
   {"reverse", str_reverse},
   {"sub", str_sub},
@@ -1875,6 +2103,32 @@ static const luaL_Reg strlib[] = {
 };
 
 
+static const luaL_Reg pattfuncs[] = {
+  {"find", str_find},
+  {"gmatch", gmatch},
+  {"gsub", str_gsub},
+  {"match", str_match},
+  {NULL, NULL}
+};
+
+
+/*
+** Register the pattern-matching functions and create their cache.
+*/
+static void setpattfuncs (lua_State *L) {
+  PatCache *pc = (PatCache *)lua_newuserdatauv(L, sizeof(PatCache),
+                                                  PATCACHE_N);
+  int i;
+  pc->clock = 0;
+  for (i = 0; i < PATCACHE_N; i++) {
+    pc->e[i].p = NULL;
+    pc->e[i].lp = 0;
+    pc->e[i].stamp = 0;
+  }
+  luaL_setfuncs(L, pattfuncs, 1);
+}
+
+
 static void createmetatable (lua_State *L) {
   /* table to be metatable for strings */
   luaL_newlibtable(L, stringmetamethods);
@@ -1894,6 +2148,7 @@ static void createmetatable (lua_State *L) {
 */
 LUAMOD_API int luaopen_string (lua_State *L) {
   luaL_newlib(L, strlib);
+  setpattfuncs(L);
   createmetatable(L);
   return 1;
 }
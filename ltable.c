@@ -59,7 +59,7 @@ typedef union {
   char padding[offsetof(Limbox_aux, follows_pNode)];
 } Limbox;
 
-#define haslastfree(t)     ((t)->lsizenode >= LIMFORLAST)
+#define haslastfree(t)     ((t)->lsizenode >= 2 * LIMFORLAST)
 #define getlastfree(t)     ((cast(Limbox *, (t)->node) - 1)->lastfree)
 
 
@@ -101,9 +101,21 @@ typedef union {
 
 /*
 ** When the original hash value is good, hashing by a power of 2
-** avoids the cost of '%'.
+** avoids the cost of '%'. For a size 1.5 * 2^k, that becomes a '%'
+** by 3 (cheap, as it is a constant) of the bits above the k lowest
+** ones, which are kept; that is the same as a '%' by the size.
 */
-#define hashpow2(t,n)		(gnode(t, lmod((n), sizenode(t))))
+l_sinline unsigned hashbits (unsigned n, unsigned c) {
+  unsigned k = c >> 1;
+  if (!(c & 1))  /* power of 2? */
+    return lmod(n, twoto(k));
+  else {  /* 1.5 * 2^(k - 1) */
+    k--;
+    return (((n >> k) % 3u) << k) | lmod(n, twoto(k));
+  }
+}
+
+#define hashpow2(t,n)		(gnode(t, hashbits((n), (t)->lsizenode)))
 
 /*
 ** for other types, it is better to avoid modulo by power of 2, as
@@ -338,7 +350,10 @@ static unsigned keyinarray (Table *t, const TValue *key) {
 /*
 ** returns the index of a 'key' for table traversals. First goes all
 ** elements in the array part, then elements in the hash part. The
-** beginning of a traversal is signaled by 0.
+** beginning of a traversal is signaled by 0. A key in the hash part is
+** first checked against 'nexthint', the position of the last key
+** returned by 'luaH_next' (for any table); in a regular traversal, it
+** is that same key, so the traversal avoids a hash lookup per step.
 */
 static unsigned findindex (lua_State *L, Table *t, TValue *key,
                                unsigned asize) {
@@ -348,10 +363,13 @@ static unsigned findindex (lua_State *L, Table *t, TValue *key,
   if (i != 0)  /* is 'key' inside array part? */
     return i;  /* yes; that's the index */
   else {
-    const TValue *n = getgeneric(t, key, 1);
-    if (l_unlikely(isabstkey(n)))
-      luaG_runerror(L, "invalid key to 'next'");  /* key not found */
-    i = cast_uint(nodefromval(n) - gnode(t, 0));  /* key index in hash table */
+    i = G(L)->nexthint;  /* where the last traversal stopped */
+    if (!(i < sizenode(t) && equalkey(key, gnode(t, i), 1))) {
+      const TValue *n = getgeneric(t, key, 1);
+      if (l_unlikely(isabstkey(n)))
+        luaG_runerror(L, "invalid key to 'next'");  /* key not found */
+      i = cast_uint(nodefromval(n) - gnode(t, 0));  /* key index in hash table */
+    }
     /* hash elements are numbered after array ones */
     return (i + 1) + asize;
   }
@@ -374,6 +392,7 @@ int luaH_next (lua_State *L, Table *t, StkId key) {
       Node *n = gnode(t, i);
       getnodekey(L, s2v(key), n);
       setobj2s(L, key + 1, gval(n));
+      G(L)->nexthint = i;  /* next call will probably start here */
       return 1;
     }
   }
@@ -592,6 +611,20 @@ static Value *resizearray (lua_State *L , Table *t,
 }
 
 
+/*
+** Initializes the 'size' nodes of a new hash part as empty.
+*/
+static void clearnodes (Table *t, unsigned size) {
+  unsigned i;
+  for (i = 0; i < size; i++) {
+    Node *n = gnode(t, i);
+    gnext(n) = 0;
+    setnilkey(n);
+    setempty(gval(n));
+  }
+}
+
+
 /*
 ** Creates an array for the hash part of a table with the given
 ** size, or reuses the dummy node if size is zero.
@@ -606,12 +639,11 @@ static void setnodevector (lua_State *L, Table *t, unsigned size) {
     setdummy(t);  /* signal that it is using dummy node */
   }
   else {
-    int i;
-    int lsize = luaO_ceillog2(size);
-    if (lsize > MAXHBITS || (1 << lsize) > MAXHSIZE)
+    int lsize = luaO_sizecode(size);
+    if (lsize > 2 * MAXHBITS || nodesize(lsize) > MAXHSIZE)
       luaG_runerror(L, "table overflow");
-    size = twoto(lsize);
-    if (lsize < LIMFORLAST)  /* no 'lastfree' field? */
+    size = nodesize(lsize);
+    if (lsize < 2 * LIMFORLAST)  /* no 'lastfree' field? */
       t->node = luaM_newvector(L, size, Node);
     else {
       size_t bsize = size * sizeof(Node) + sizeof(Limbox);
@@ -621,12 +653,7 @@ static void setnodevector (lua_State *L, Table *t, unsigned size) {
     }
     t->lsizenode = cast_byte(lsize);
     setnodummy(t);
-    for (i = 0; i < cast_int(size); i++) {
-      Node *n = gnode(t, i);
-      gnext(n) = 0;
-      setnilkey(n);
-      setempty(gval(n));
-    }
+    clearnodes(t, size);
   }
 }
 
@@ -743,7 +770,10 @@ void luaH_resize (lua_State *L, Table *t, unsigned newasize,
   clearNewSlice(t, oldasize, newasize);
   /* re-insert elements from old hash part into new parts */
   reinserthash(L, &newt, t);  /* 'newt' now has the old hash */
-  freehash(L, &newt);  /* free old hash part */
+  if (hasinline(t) && newt.node == inlinenodes(t))  /* was it inline? */
+    *cast(unsigned *, inlinenodes(t)) = sizenode(&newt);  /* keep its size */
+  else
+    freehash(L, &newt);  /* free old hash part */
 }
 
 
@@ -753,6 +783,32 @@ void luaH_resizearray (lua_State *L, Table *t, unsigned int nasize) {
 }
 
 
+/*
+** Move the elements 't1[f..e]' into 't2[d..]' when all slots involved
+** are in the array parts of the tables, copying values and tags as
+** two blocks (which may overlap). Returns 0 and does nothing otherwise.
+** (The caller must ensure that 'f <= e' and that 'e - f + 1' does not
+** overflow.)
+*/
+int luaH_movearray (Table *t1, lua_Integer f, lua_Integer e,
+                    Table *t2, lua_Integer d) {
+  lua_Unsigned uf = l_castS2U(f) - 1u;  /* C indices */
+  lua_Unsigned ue = l_castS2U(e) - 1u;
+  lua_Unsigned ud = l_castS2U(d) - 1u;
+  lua_Unsigned n = ue - uf + 1u;  /* number of elements */
+  if (uf < t1->asize && ue < t1->asize &&
+      ud < t2->asize && n <= t2->asize - ud) {
+    /* values are stored in reverse order */
+    memmove(getArrVal(t2, ud + n - 1u), getArrVal(t1, ue),
+            cast_sizet(n) * sizeof(Value));
+    memmove(getArrTag(t2, ud), getArrTag(t1, uf), cast_sizet(n));
+    return 1;
+  }
+  else
+    return 0;
+}
+
+
 /*
 ** Rehash a table. First, count its keys. If there are array indices
 ** outside the array part, compute the new best size for that part.
@@ -807,9 +863,51 @@ Table *luaH_new (lua_State *L) {
 }
 
 
+/*
+** Creates a new table without an array part and with a hash part of
+** size 'hsize' (at most MAXINLINE), allocated inline.
+*/
+Table *luaH_newrecord (lua_State *L, unsigned hsize) {
+  lua_assert(hsize <= MAXINLINE);
+  if (hsize == 0)
+    return luaH_new(L);
+  else {
+    int lsize = luaO_sizecode(hsize);
+    unsigned size = nodesize(lsize);
+    GCObject *o = luaC_newobj(L, LUA_VTABLE,
+                                 INLINEOFFSET + size * sizeof(Node));
+    Table *t = gco2t(o);
+    lua_assert(lsize < 2 * LIMFORLAST);  /* no 'lastfree' field */
+    t->metatable = NULL;
+    t->flags = cast_byte(maskflags | BITINLINE);
+    t->array = NULL;
+    t->asize = 0;
+    t->node = inlinenodes(t);
+    t->lsizenode = cast_byte(lsize);
+    clearnodes(t, size);
+    return t;
+  }
+}
+
+
+/*
+** Size of the table structure plus its inline room, if any. When the
+** table is not using that room anymore, its size is kept there.
+*/
+static size_t sizetable (Table *t) {
+  if (!hasinline(t))
+    return sizeof(Table);
+  else {
+    unsigned n = nodeisinline(t) ? sizenode(t)
+                                 : *cast(unsigned *, inlinenodes(t));
+    return INLINEOFFSET + cast_sizet(n) * sizeof(Node);
+  }
+}
+
+
 lu_mem luaH_size (Table *t) {
-  lu_mem sz = cast(lu_mem, sizeof(Table)) + concretesize(t->asize);
-  if (!isdummy(t))
+  lu_mem sz = cast(lu_mem, sizetable(t)) + concretesize(t->asize);
+  if (!isdummy(t) && !nodeisinline(t))
     sz += sizehash(t);
   return sz;
 }
@@ -819,9 +917,10 @@ lu_mem luaH_size (Table *t) {
 ** Frees a table.
 */
 void luaH_free (lua_State *L, Table *t) {
-  freehash(L, t);
+  if (!nodeisinline(t))
+    freehash(L, t);
   resizearray(L, t, t->asize, 0);
-  luaM_free(L, t);
+  luaM_freemem(L, t, sizetable(t));
 }
 
 
@@ -992,6 +1091,19 @@ lu_byte luaH_getshortstr (Table *t, TString *key, TValue *res) {
 }
 
 
+/*
+** Slow path for 'luaH_fastgetshortstr': search the key and, if it is
+** present and there is a cache, update 'hint' with the index of its node.
+*/
+lu_byte luaH_getshortstrhint (Table *t, TString *key, TValue *res,
+                                        unsigned *hint) {
+  const TValue *slot = luaH_Hgetshortstr(t, key);
+  if (hint != NULL && !isabstkey(slot))
+    *hint = cast_uint(nodefromval(slot) - gnode(t, 0));
+  return finishnodeget(slot, res);
+}
+
+
 static const TValue *Hgetlongstr (Table *t, TString *key) {
   TValue ko;
   lua_assert(!strisshr(key));
@@ -1094,8 +1206,11 @@ static int psetint (Table *t, lua_Integer key, TValue *val) {
 ** it is not old/black, and it already has space for the key.
 */
 
-int luaH_psetshortstr (Table *t, TString *key, TValue *val) {
+static int psetshortstr (Table *t, TString *key, TValue *val,
+                                   unsigned *hint) {
   const TValue *slot = luaH_Hgetshortstr(t, key);
+  if (hint != NULL && !isabstkey(slot))
+    *hint = cast_uint(nodefromval(slot) - gnode(t, 0));
   if (!ttisnil(slot)) {  /* key already has a value? (all too common) */
     setobj(((lua_State*)NULL), cast(TValue*, slot), val);  /* update it */
     return HOK;  /* done */
@@ -1120,6 +1235,21 @@ int luaH_psetshortstr (Table *t, TString *key, TValue *val) {
 }
 
 
+int luaH_psetshortstr (Table *t, TString *key, TValue *val) {
+  return psetshortstr(t, key, val, NULL);
+}
+
+
+/*
+** Slow path for 'luaH_fastsetshortstr': as 'luaH_psetshortstr', but
+** also updates 'hint' (if not NULL) when the key is present.
+*/
+int luaH_psetshortstrhint (Table *t, TString *key, TValue *val,
+                                     unsigned *hint) {
+  return psetshortstr(t, key, val, hint);
+}
+
+
 int luaH_psetstr (Table *t, TString *key, TValue *val) {
   if (strisshr(key))
     return luaH_psetshortstr(t, key, val);
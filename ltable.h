@@ -36,6 +36,28 @@
 #define setdummy(t)		((t)->flags |= BITDUMMY)
 
 
+/*
+** Bit BITINLINE set in 'flags' means the table was created with room
+** for an inline hash part, allocated in the same block right after the
+** structure Table (see 'luaH_newrecord'). Small records thus need a
+** single allocation. A table keeps that room while it lives, even after
+** its hash part moves elsewhere. MAXINLINE is the largest size for an
+** inline hash part. INLINEOFFSET, where the inline nodes start, is
+** 'sizeof(Table)' rounded up so that a Node is properly aligned there.
+*/
+
+typedef struct { Table dummy; Node follows_Table; } Inlinebox_aux;
+
+#define INLINEOFFSET		offsetof(Inlinebox_aux, follows_Table)
+
+#define BITINLINE		(1 << 7)
+#define hasinline(t)		((t)->flags & BITINLINE)
+#define inlinenodes(t)		cast(Node *, cast_charp(t) + INLINEOFFSET)
+#define nodeisinline(t)		(hasinline(t) && (t)->node == inlinenodes(t))
+
+#define MAXINLINE		6
+
+
 
 /* allocated size for hash nodes */
 #define allocsizenode(t)	(isdummy(t) ? 0 : sizenode(t))
@@ -64,6 +86,34 @@
     else { hres = luaH_psetint(h, k, val); }}
 
 
+/*
+** Inline caches for short-string keys. 'hint' points to the index of
+** the node where the key was last found (see 'luaV_execute'), or is
+** NULL when there is no cache. A hint is always validated against the
+** key in that node, so it is harmless when the table was resized or the
+** node was reused. Tables built by inserting the same keys in the same
+** order (e.g., by the same constructor) get the same node layout, so a
+** single hint usually serves all of them.
+*/
+#define checkhint(h,k,hp,ih) \
+  ((hp) != NULL && ((ih) = *(hp)) < sizenode(h) && \
+   keyisshrstr(gnode(h, ih)) && eqshrstr(keystrval(gnode(h, ih)), k))
+
+#define luaH_fastgetshortstr(t,k,res,tag,hint) \
+  { Table *h = t; unsigned *hp = (hint); unsigned ih; \
+    if (checkhint(h, k, hp, ih)) { \
+      const TValue *v = gval(gnode(h, ih)); \
+      tag = ttypetag(v); \
+      if (!tagisempty(tag)) { setobj(((lua_State*)NULL), res, v); }} \
+    else { tag = luaH_getshortstrhint(h, (k), res, hp); }}
+
+#define luaH_fastsetshortstr(t,k,val,hres,hint) \
+  { Table *h = t; unsigned *hp = (hint); unsigned ih; \
+    if (checkhint(h, k, hp, ih) && !ttisnil(gval(gnode(h, ih)))) { \
+      setobj(((lua_State*)NULL), gval(gnode(h, ih)), val); hres = HOK; } \
+    else { hres = luaH_psetshortstrhint(h, (k), val, hp); }}
+
+
 /* results from pset */
 #define HOK		0
 #define HNOTFOUND	1
@@ -148,6 +198,8 @@
 
 LUAI_FUNC lu_byte luaH_get (Table *t, const TValue *key, TValue *res);
 LUAI_FUNC lu_byte luaH_getshortstr (Table *t, TString *key, TValue *res);
+LUAI_FUNC lu_byte luaH_getshortstrhint (Table *t, TString *key, TValue *res,
+                                                   unsigned *hint);
 LUAI_FUNC lu_byte luaH_getstr (Table *t, TString *key, TValue *res);
 LUAI_FUNC lu_byte luaH_getint (Table *t, lua_Integer key, TValue *res);
 
@@ -156,6 +208,8 @@ LUAI_FUNC const TValue *luaH_Hgetshortstr (Table *t, TString *key);
 
 LUAI_FUNC int luaH_psetint (Table *t, lua_Integer key, TValue *val);
 LUAI_FUNC int luaH_psetshortstr (Table *t, TString *key, TValue *val);
+LUAI_FUNC int luaH_psetshortstrhint (Table *t, TString *key, TValue *val,
+                                                unsigned *hint);
 LUAI_FUNC int luaH_psetstr (Table *t, TString *key, TValue *val);
 LUAI_FUNC int luaH_pset (Table *t, const TValue *key, TValue *val);
 
@@ -167,9 +221,12 @@ LUAI_FUNC void luaH_set (lua_State *L, Table *t, const TValue *key,
 LUAI_FUNC void luaH_finishset (lua_State *L, Table *t, const TValue *key,
                                               TValue *value, int hres);
 LUAI_FUNC Table *luaH_new (lua_State *L);
+LUAI_FUNC Table *luaH_newrecord (lua_State *L, unsigned hsize);
 LUAI_FUNC void luaH_resize (lua_State *L, Table *t, unsigned nasize,
                                                     unsigned nhsize);
 LUAI_FUNC void luaH_resizearray (lua_State *L, Table *t, unsigned nasize);
+LUAI_FUNC int luaH_movearray (Table *t1, lua_Integer f, lua_Integer e,
+                                          Table *t2, lua_Integer d);
 LUAI_FUNC lu_mem luaH_size (Table *t);
 LUAI_FUNC void luaH_free (lua_State *L, Table *t);
 LUAI_FUNC int luaH_next (lua_State *L, Table *t, StkId key);
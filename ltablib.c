@@ -61,6 +61,26 @@ static void checktab (lua_State *L, int arg, int what) {
 }
 
 
+/*
+** Check whether the table at 'arg' can have its elements moved with
+** raw accesses, that is, whether it is a real table without '__index'
+** and '__newindex' metamethods.
+*/
+static int israwtable (lua_State *L, int arg) {
+  if (lua_type(L, arg) != LUA_TTABLE)
+    return 0;
+  else if (!lua_getmetatable(L, arg))
+    return 1;  /* no metatable */
+  else {
+    int n = 1;  /* number of elements to pop */
+    int res = (!checkfield(L, "__index", ++n) &&
+               !checkfield(L, "__newindex", ++n));
+    lua_pop(L, n);
+    return res;
+  }
+}
+
+
 static int tcreate (lua_State *L) {
   lua_Unsigned sizeseq = (lua_Unsigned)luaL_checkinteger(L, 1);
   lua_Unsigned sizerest = (lua_Unsigned)luaL_optinteger(L, 2, 0);
@@ -86,7 +106,15 @@ static int tinsert (lua_State *L) {
       /* check whether 'pos' is in [1, e] */
       luaL_argcheck(L, (lua_Unsigned)pos - 1u < (lua_Unsigned)e, 2,
                        "position out of bounds");
-      for (i = e; i > pos; i--) {  /* move up elements */
+      i = e;
+      if (pos < e) {
+        lua_geti(L, 1, e - 1);
+        lua_seti(L, 1, e);  /* t[e] = t[e - 1] (may grow the array) */
+        i = e - 1;
+        if (israwtable(L, 1) && lua_rawmove(L, 1, pos, e - 2, pos + 1, 1))
+          i = pos;  /* moved up the other elements at once */
+      }
+      for (; i > pos; i--) {  /* move up elements */
         lua_geti(L, 1, i - 1);
         lua_seti(L, 1, i);  /* t[i] = t[i - 1] */
       }
@@ -109,6 +137,9 @@ static int tremove (lua_State *L) {
     luaL_argcheck(L, (lua_Unsigned)pos - 1u <= (lua_Unsigned)size, 2,
                      "position out of bounds");
   lua_geti(L, 1, pos);  /* result = t[pos] */
+  if (pos < size && israwtable(L, 1) &&
+      lua_rawmove(L, 1, pos + 1, size, pos, 1))
+    pos = size;  /* moved down all elements at once */
   for ( ; pos < size; pos++) {
     lua_geti(L, 1, pos + 1);
     lua_seti(L, 1, pos);  /* t[pos] = t[pos + 1] */
@@ -139,7 +170,11 @@ static int tmove (lua_State *L) {
     n = e - f + 1;  /* number of elements to move */
     luaL_argcheck(L, t <= LUA_MAXINTEGER - n + 1, 4,
                   "destination wrap around");
-    if (t > e || t <= f || (tt != 1 && !lua_compare(L, 1, tt, LUA_OPEQ))) {
+    if (israwtable(L, 1) && israwtable(L, tt) &&
+        lua_rawmove(L, 1, f, e, t, tt))
+      ;  /* moved all elements at once */
+    else if (t > e || t <= f ||
+             (tt != 1 && !lua_compare(L, 1, tt, LUA_OPEQ))) {
       for (i = 0; i < n; i++) {
         lua_geti(L, 1, f + i);
         lua_seti(L, tt, t + i);
@@ -394,6 +429,208 @@ static void auxsort (lua_State *L, IdxT lo, IdxT up, unsigned rnd) {
 }
 
 
+/* }====================================================== */
+
+
+/*
+** {======================================================
+** Fast path for sorting plain arrays of integers, floats, or strings
+** with the default order. The values are copied to a C buffer, sorted
+** there with an introsort specialized for their type, and copied back.
+** It uses only raw accesses, so it is used only for real tables
+** without metatables and without a comparison function.
+** =======================================================
+*/
+
+
+/* a string in the buffer, with its original position in the table */
+typedef struct SortStr {
+  const char *s;
+  size_t len;
+  IdxT idx;
+} SortStr;
+
+
+/* strings use the same order as the '<' operator */
+#define strless(a,b)	(lua_strcmp((a)->s, (a)->len, (b)->s, (b)->len) < 0)
+
+#define intless(a,b)	(*(a) < *(b))
+#define fltless(a,b)	(*(a) < *(b))
+
+
+/* arrays up to this size are sorted by insertion */
+#define SORTSMALL	16
+
+
+/*
+** Define an introsort 'name' for arrays of 'T' ordered by 'less',
+** which receives pointers to the elements: quicksort with a
+** median-of-three pivot, insertion sort for small intervals, and
+** heapsort when the recursion gets too deep.
+*/
+#define DEFSORT(name,T,less)  \
+static void name##_heap (T *a, size_t n) {  \
+  size_t i = n / 2;  \
+  for (;;) {  \
+    T x;  size_t p, c;  \
+    if (i > 0) x = a[--i];  /* building the heap */  \
+    else if (--n > 0) { x = a[n]; a[n] = a[0]; }  /* extracting max. */  \
+    else return;  \
+    for (p = i; (c = 2 * p + 1) < n; p = c) {  /* sift 'x' down */  \
+      if (c + 1 < n && less(&a[c], &a[c + 1])) c++;  \
+      if (!less(&x, &a[c])) break;  \
+      a[p] = a[c];  \
+    }  \
+    a[p] = x;  \
+  }  \
+}  \
+static void name (T *a, size_t n, int depth) {  \
+  while (n > SORTSMALL) {  \
+    size_t i, j, m = n / 2;  \
+    T p, t;  \
+    if (depth-- == 0) { name##_heap(a, n); return; }  \
+    /* put median of a[0], a[m], a[n-1] in a[0] */  \
+    if (less(&a[m], &a[0])) { t = a[m]; a[m] = a[0]; a[0] = t; }  \
+    if (less(&a[n - 1], &a[m])) {  \
+      t = a[n - 1]; a[n - 1] = a[m]; a[m] = t;  \
+      if (less(&a[m], &a[0])) { t = a[m]; a[m] = a[0]; a[0] = t; }  \
+    }  \
+    t = a[m]; a[m] = a[0]; a[0] = t;  \
+    p = a[0];  /* pivot */  \
+    i = 0; j = n;  \
+    for (;;) {  /* Hoare partition; ends with 0 <= j < n - 1 */  \
+      while (less(&a[i], &p)) i++;  \
+      do j--; while (less(&p, &a[j]));  \
+      if (i >= j) break;  \
+      t = a[i]; a[i] = a[j]; a[j] = t;  \
+      i++;  \
+    }  \
+    /* a[0 .. j] <= p <= a[j + 1 .. n - 1]; recurse into smaller part */  \
+    if (j + 1 < n - j - 1) {  \
+      name(a, j + 1, depth);  \
+      a += j + 1; n -= j + 1;  \
+    }  \
+    else {  \
+      name(a + j + 1, n - j - 1, depth);  \
+      n = j + 1;  \
+    }  \
+  }  \
+  { size_t i;  /* insertion sort */  \
+    for (i = 1; i < n; i++) {  \
+      T x = a[i];  size_t j = i;  \
+      for (; j > 0 && less(&x, &a[j - 1]); j--) a[j] = a[j - 1];  \
+      a[j] = x;  \
+    }  \
+  }  \
+}
+
+DEFSORT(sortint, lua_Integer, intless)
+DEFSORT(sortflt, lua_Number, fltless)
+DEFSORT(sortstr, SortStr, strless)
+
+
+/* maximum recursion depth before switching to heapsort */
+static int maxdepth (IdxT n) {
+  int d = 0;
+  for (; n > 0; n >>= 1) d += 2;
+  return d;
+}
+
+
+/*
+** Put back in the table the strings sorted in 'a', following the
+** cycles of the permutation given by the original positions.
+*/
+static void permute (lua_State *L, SortStr *a, IdxT n) {
+  IdxT i;
+  for (i = 0; i < n; i++) {
+    IdxT j = i;
+    if (a[i].idx == i) continue;  /* already in place */
+    lua_rawgeti(L, 1, l_castU2S(i) + 1);  /* save first value of cycle */
+    for (;;) {
+      IdxT k = a[j].idx;
+      a[j].idx = j;  /* mark position 'j' as done */
+      if (k == i) break;  /* end of cycle? */
+      lua_rawgeti(L, 1, l_castU2S(k) + 1);  /* t[j] = t[k] */
+      lua_rawseti(L, 1, l_castU2S(j) + 1);
+      j = k;
+    }
+    lua_rawseti(L, 1, l_castU2S(j) + 1);  /* close the cycle */
+  }
+}
+
+
+/*
+** Try to sort 't[1 .. n]' with the fast path. Returns 0 (leaving the
+** table untouched) if the array is not homogeneous.
+*/
+static int fastsort (lua_State *L, IdxT n) {
+  IdxT i;
+  int tt, isint;
+  if (sizeof(n) >= sizeof(size_t) &&
+      (size_t)n + 1 > (~(size_t)0) / sizeof(SortStr))
+    return 0;  /* buffer size would overflow */
+  tt = lua_rawgeti(L, 1, 1);
+  isint = lua_isinteger(L, -1);
+  lua_pop(L, 1);
+  if (tt == LUA_TNUMBER) {
+    /* 'lua_Integer' and 'lua_Number' share the buffer */
+    size_t sz = (sizeof(lua_Integer) > sizeof(lua_Number))
+              ? sizeof(lua_Integer) : sizeof(lua_Number);
+    void *buff = lua_newuserdatauv(L, n * sz, 0);
+    lua_Integer *ai = (lua_Integer *)buff;
+    lua_Number *af = (lua_Number *)buff;
+    for (i = 0; i < n; i++) {
+      lua_rawgeti(L, 1, l_castU2S(i) + 1);
+      if (isint) {
+        if (!lua_isinteger(L, -1)) return 0;
+        ai[i] = lua_tointeger(L, -1);
+      }
+      else {
+        lua_Number f;
+        if (lua_type(L, -1) != LUA_TNUMBER || lua_isinteger(L, -1))
+          return 0;
+        f = lua_tonumber(L, -1);
+        if (f != f) return 0;  /* NaN has no order */
+        af[i] = f;
+      }
+      lua_pop(L, 1);
+    }
+    if (isint) {
+      sortint(ai, n, maxdepth(n));
+      for (i = 0; i < n; i++) {
+        lua_pushinteger(L, ai[i]);
+        lua_rawseti(L, 1, l_castU2S(i) + 1);
+      }
+    }
+    else {
+      sortflt(af, n, maxdepth(n));
+      for (i = 0; i < n; i++) {
+        lua_pushnumber(L, af[i]);
+        lua_rawseti(L, 1, l_castU2S(i) + 1);
+      }
+    }
+    return 1;
+  }
+  else if (tt == LUA_TSTRING) {
+    SortStr *a = (SortStr *)lua_newuserdatauv(L, n * sizeof(SortStr), 0);
+    for (i = 0; i < n; i++) {
+      if (lua_rawgeti(L, 1, l_castU2S(i) + 1) != LUA_TSTRING)
+        return 0;
+      /* strings stay anchored in the table while 'a' is in use */
+      a[i].s = lua_tolstring(L, -1, &a[i].len);
+      a[i].idx = i;
+      lua_pop(L, 1);
+    }
+    sortstr(a, n, maxdepth(n));
+    permute(L, a, n);
+    return 1;
+  }
+  else
+    return 0;
+}
+
+
 static int sort (lua_State *L) {
   lua_Integer n = aux_getn(L, 1, TAB_RW);
   if (n > 1) {  /* non-trivial interval? */
@@ -401,6 +638,10 @@ static int sort (lua_State *L) {
     if (!lua_isnoneornil(L, 2))  /* is there a 2nd argument? */
       luaL_checktype(L, 2, LUA_TFUNCTION);  /* must be a function */
     lua_settop(L, 2);  /* make sure there are two arguments */
+    if (lua_isnil(L, 2) && lua_type(L, 1) == LUA_TTABLE &&
+        !lua_getmetatable(L, 1) && fastsort(L, (IdxT)n))
+      return 0;  /* done by the fast path */
+    lua_settop(L, 2);  /* remove any leftovers from the fast path */
     auxsort(L, 1, (IdxT)n, 0);
   }
   return 0;
@@ -532,9 +532,17 @@ static void checkrefs (global_State *g, GCObject *o) {
       checkproto(g, gco2p(o));
       break;
     }
-    case LUA_VSHRSTR:
+    case LUA_VSHRSTR: {
+      assert(!isgray(o));  /* strings are never gray */
+      break;
+    }
     case LUA_VLNGSTR: {
+      TString *ts = gco2ts(o);
       assert(!isgray(o));  /* strings are never gray */
+      if (ts->shrlen == LSTRVIEW) {  /* view? */
+        assert(strparent(ts)->shrlen != LSTRVIEW);
+        checkobjref(g, o, obj2gco(strparent(ts)));
+      }
       break;
     }
     default: assert(0);
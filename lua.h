@@ -235,6 +235,8 @@ LUA_API void  (lua_arith) (lua_State *L, int op);
 
 LUA_API int   (lua_rawequal) (lua_State *L, int idx1, int idx2);
 LUA_API int   (lua_compare) (lua_State *L, int idx1, int idx2, int op);
+LUA_API int   (lua_strcmp) (const char *s1, size_t l1,
+                            const char *s2, size_t l2);
 
 
 /*
@@ -246,6 +248,8 @@ LUA_API void        (lua_pushinteger) (lua_State *L, lua_Integer n);
 LUA_API const char *(lua_pushlstring) (lua_State *L, const char *s, size_t len);
 LUA_API const char *(lua_pushexternalstring) (lua_State *L,
 		const char *s, size_t len, lua_Alloc falloc, void *ud);
+LUA_API const char *(lua_pushsubstring) (lua_State *L, int idx,
+		size_t i, size_t len);
 LUA_API const char *(lua_pushstring) (lua_State *L, const char *s);
 LUA_API const char *(lua_pushvfstring) (lua_State *L, const char *fmt,
                                                       va_list argp);
@@ -283,6 +287,8 @@ LUA_API void  (lua_seti) (lua_State *L, int idx, lua_Integer n);
 LUA_API void  (lua_rawset) (lua_State *L, int idx);
 LUA_API void  (lua_rawseti) (lua_State *L, int idx, lua_Integer n);
 LUA_API void  (lua_rawsetp) (lua_State *L, int idx, const void *p);
+LUA_API int   (lua_rawmove) (lua_State *L, int idx1, lua_Integer f,
+                             lua_Integer e, lua_Integer t, int idx2);
 LUA_API int   (lua_setmetatable) (lua_State *L, int objindex);
 LUA_API int   (lua_setiuservalue) (lua_State *L, int idx, int n);
 
@@ -483,6 +489,12 @@ LUA_API lua_Hook (lua_gethook) (lua_State *L);
 LUA_API int (lua_gethookmask) (lua_State *L);
 LUA_API int (lua_gethookcount) (lua_State *L);
 
+#if defined(LUA_USE_OPCOUNT)
+LUA_API const char *(lua_getopcount) (lua_State *L, int op, int next,
+                                      lua_Unsigned *count);
+LUA_API void (lua_resetopcounts) (lua_State *L);
+#endif
+
 
 struct lua_Debug {
   int event;
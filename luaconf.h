@@ -701,6 +701,23 @@
 */
 /* #define LUA_USE_APICHECK */
 
+
+/*
+@@ LUA_USE_OPCOUNT makes the interpreter count how many times each
+** opcode, and each pair of consecutive opcodes, is executed (see
+** 'lua_getopcount'). It slows down the interpreter.
+*/
+/* #define LUA_USE_OPCOUNT */
+
+
+/*
+@@ LUA_USE_WORDHASH makes Lua hash strings a machine word at a time,
+** which is much faster for longer strings. It changes the hash values
+** (and therefore the traversal order of tables), but they are still
+** deterministic for a given build and seed.
+*/
+/* #define LUA_USE_WORDHASH */
+
 /* }================================================================== */
 
 
@@ -26,7 +26,11 @@
 */
 #define LUAC_VERSION	(LUA_VERSION_MAJOR_N*16+LUA_VERSION_MINOR_N)
 
-#define LUAC_FORMAT	0	/* this is the official format */
+/*
+** Format of binary chunks: 0 had hash sizes in OP_NEWTABLE as log2;
+** 1 has them as size codes (see 'nodesize')
+*/
+#define LUAC_FORMAT	1
 
 
 /* load one chunk; from lundump.c */
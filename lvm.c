@@ -381,18 +381,15 @@ void luaV_finishset (lua_State *L, const TValue *t, TValue *key,
 
 
 /*
-** Compare two strings 'ts1' x 'ts2', returning an integer less-equal-
-** -greater than zero if 'ts1' is less-equal-greater than 'ts2'.
+** Compare two strings 's1' x 's2' (with lengths 'rl1' and 'rl2'),
+** returning an integer less-equal-greater than zero if 's1' is
+** less-equal-greater than 's2'. (Also used by 'lua_strcmp'.)
 ** The code is a little tricky because it allows '\0' in the strings
 ** and it uses 'strcoll' (to respect locales) for each segment
 ** of the strings. Note that segments can compare equal but still
 ** have different lengths.
 */
-static int l_strcmp (const TString *ts1, const TString *ts2) {
-  size_t rl1;  /* real length */
-  const char *s1 = getlstr(ts1, rl1);
-  size_t rl2;
-  const char *s2 = getlstr(ts2, rl2);
+int luaV_strcmp (const char *s1, size_t rl1, const char *s2, size_t rl2) {
   for (;;) {  /* for each segment */
     int temp = l_strcoll(s1, s2);
     if (temp != 0)  /* not equal? */
@@ -412,6 +409,14 @@ static int l_strcmp (const TString *ts1, const TString *ts2) {
 }
 
 
+static int l_strcmp (const TString *ts1, const TString *ts2) {
+  size_t rl1, rl2;  /* real lengths */
+  const char *s1 = getlstr(ts1, rl1);
+  const char *s2 = getlstr(ts2, rl2);
+  return luaV_strcmp(s1, rl1, s2, rl2);
+}
+
+
 /*
 ** Check whether integer 'i' is less than float 'f'. If 'i' has an
 ** exact representation as a float ('l_intfitsf'), compare numbers as
@@ -914,6 +919,51 @@ void luaV_finishOp (lua_State *L) {
 
 
 
+/*
+** Allocation-site feedback for OP_NEWTABLE. Tables created by the same
+** instruction tend to reach the same sizes. When the instruction runs
+** again, its register often still holds the table it created the
+** previous time (e.g., in a loop or in repeated calls to a function),
+** already filled. Then the new table is created with the sizes of the
+** previous one, skipping its intermediate rehashes. The inline cache
+** keeps a tag of the last table created by the instruction (to
+** recognize it) plus the sizes learned so far, plus 1 (or 0 for an
+** empty part): log2 of the array size in 4 bits and the size code of
+** the hash part (see 'nodesize') in 5 bits. The tag is never used as
+** a pointer; a false match only gives a wrong size hint. Sizes above
+** 2^MAXFEEDBACK are not learned, to bound what a wrong guess wastes.
+*/
+#define MAXFEEDBACK	8
+
+#define tabletag(t)	((point2uint(t) << 4) & ~0x1ffu)
+
+/* 'ceillog2(x) + 1' for a size 'x', or 0 for an empty part */
+#define sizelog(x)	((x) == 0 ? 0 : cast_uint(luaO_ceillog2(x)) + 1)
+
+
+static unsigned tablefeedback (const TValue *old, unsigned cache,
+                               unsigned *asize, unsigned *hsize) {
+  unsigned la, lh;
+  if (ttistable(old) && tabletag(hvalue(old)) == (cache & ~0x1ffu)) {
+    /* a register is marked or cleared by 'atomic', so 'h' is alive */
+    Table *h = hvalue(old);  /* table created by this instruction */
+    la = sizelog(h->asize);
+    lh = isdummy(h) ? 0 : cast_uint(h->lsizenode) + 1;
+    if (la > MAXFEEDBACK + 1) la = 0;
+    if (lh > 2 * MAXFEEDBACK + 1) lh = 0;
+  }
+  else {  /* keep what was learned before */
+    la = cache & 0xfu;
+    lh = (cache >> 4) & 0x1fu;
+  }
+  if (la > 0 && *asize < (1u << (la - 1)))
+    *asize = 1u << (la - 1);
+  if (lh > 0 && *hsize < nodesize(lh - 1))
+    *hsize = nodesize(lh - 1);
+  return la | (lh << 4);
+}
+
+
 /*
 ** {==================================================================
 ** Macros for arithmetic/bitwise/comparison opcodes in 'luaV_execute'
@@ -1045,10 +1095,10 @@ void luaV_finishOp (lua_State *L) {
 
 /*
 ** Order operations with register operands. 'opn' actually works
-** for all numbers, but the fast track improves performance for
-** integers.
+** for all numbers, but the fast tracks improve performance for
+** operands with the same numeric type, the usual case in loops.
 */
-#define op_order(L,opi,opn,other) {  \
+#define op_order(L,opi,opf,opn,other) {  \
   TValue *ra = vRA(i); \
   int cond;  \
   TValue *rb = vRB(i);  \
@@ -1057,6 +1107,8 @@ void luaV_finishOp (lua_State *L) {
     lua_Integer ib = ivalue(rb);  \
     cond = opi(ia, ib);  \
   }  \
+  else if (ttisfloat(ra) && ttisfloat(rb))  \
+    cond = opf(fltvalue(ra), fltvalue(rb));  \
   else if (ttisnumber(ra) && ttisnumber(rb))  \
     cond = opn(ra, rb);  \
   else  \
@@ -1109,6 +1161,9 @@ void luaV_finishOp (lua_State *L) {
 #define KC(i)	(k+GETARG_C(i))
 #define RKC(i)	((TESTARG_k(i)) ? k + GETARG_C(i) : s2v(base + GETARG_C(i)))
 
+/* inline cache of the current instruction (NULL if there are no caches) */
+#define ICACHE()  \
+	(cl->p->icache ? cl->p->icache + pcRel(pc, cl->p) : NULL)
 
 
 #define updatetrap(ci)  (trap = ci->u.l.trap)
@@ -1181,6 +1236,15 @@ void luaV_finishOp (lua_State *L) {
            luai_threadyield(L); }
 
 
+/* count executed opcodes (see 'lua_getopcount') */
+#if defined(LUA_USE_OPCOUNT)
+#define countop(L,i)	{ global_State *g_ = G(L); int op_ = GET_OPCODE(i); \
+  g_->opcount[op_]++; g_->oppaircount[g_->lastop][op_]++; g_->lastop = op_; }
+#else
+#define countop(L,i)	((void)0)
+#endif
+
+
 /* fetch an instruction and prepare its execution */
 #define vmfetch()	{ \
   if (l_unlikely(trap)) {  /* stack reallocation or hooks? */ \
@@ -1188,6 +1252,7 @@ void luaV_finishOp (lua_State *L) {
     updatebase(ci);  /* correct stack */ \
   } \
   i = *(pc++); \
+  countop(L, i); \
 }
 
 #define vmdispatch(o)	switch(o)
@@ -1303,7 +1368,7 @@ void luaV_execute (lua_State *L, CallInfo *ci) {
         TValue *rc = KC(i);
         TString *key = tsvalue(rc);  /* key must be a short string */
         lu_byte tag;
-        luaV_fastget(upval, key, s2v(ra), luaH_getshortstr, tag);
+        luaV_fastgetshortstr(upval, key, s2v(ra), ICACHE(), tag);
         if (tagisempty(tag))
           Protect(luaV_finishget(L, upval, rc, ra, tag));
         vmbreak;
@@ -1341,7 +1406,7 @@ void luaV_execute (lua_State *L, CallInfo *ci) {
         TValue *rc = KC(i);
         TString *key = tsvalue(rc);  /* key must be a short string */
         lu_byte tag;
-        luaV_fastget(rb, key, s2v(ra), luaH_getshortstr, tag);
+        luaV_fastgetshortstr(rb, key, s2v(ra), ICACHE(), tag);
         if (tagisempty(tag))
           Protect(luaV_finishget(L, rb, rc, ra, tag));
         vmbreak;
@@ -1352,7 +1417,7 @@ void luaV_execute (lua_State *L, CallInfo *ci) {
         TValue *rb = KB(i);
         TValue *rc = RKC(i);
         TString *key = tsvalue(rb);  /* key must be a short string */
-        luaV_fastset(upval, key, rc, hres, luaH_psetshortstr);
+        luaV_fastsetshortstr(upval, key, rc, ICACHE(), hres);
         if (hres == HOK)
           luaV_finishfastset(L, upval, rc);
         else
@@ -1397,7 +1462,7 @@ void luaV_execute (lua_State *L, CallInfo *ci) {
         TValue *rb = KB(i);
         TValue *rc = RKC(i);
         TString *key = tsvalue(rb);  /* key must be a short string */
-        luaV_fastset(s2v(ra), key, rc, hres, luaH_psetshortstr);
+        luaV_fastsetshortstr(s2v(ra), key, rc, ICACHE(), hres);
         if (hres == HOK)
           luaV_finishfastset(L, s2v(ra), rc);
         else
@@ -1406,22 +1471,33 @@ void luaV_execute (lua_State *L, CallInfo *ci) {
       }
       vmcase(OP_NEWTABLE) {
         StkId ra = RA(i);
-        unsigned b = cast_uint(GETARG_vB(i));  /* log2(hash size) + 1 */
+        unsigned b = cast_uint(GETARG_vB(i));  /* hash size code + 1 */
         unsigned c = cast_uint(GETARG_vC(i));  /* array size */
+        unsigned *ic = ICACHE();
+        unsigned fb = 0;  /* sizes learned for this instruction */
         Table *t;
         if (b > 0)
-          b = 1u << (b - 1);  /* hash size is 2^(b - 1) */
+          b = nodesize(b - 1);
         if (TESTARG_k(i)) {  /* non-zero extra argument? */
           lua_assert(GETARG_Ax(*pc) != 0);
           /* add it to array size */
           c += cast_uint(GETARG_Ax(*pc)) * (MAXARG_vC + 1);
         }
         pc++;  /* skip extra argument */
+        if (ic != NULL)
+          fb = tablefeedback(s2v(ra), *ic, &c, &b);
         L->top.p = ra + 1;  /* correct top in case of emergency GC */
-        t = luaH_new(L);  /* memory allocation */
-        sethvalue2s(L, ra, t);
-        if (b != 0 || c != 0)
+        if (c == 0 && b <= MAXINLINE) {  /* small record? */
+          t = luaH_newrecord(L, b);  /* memory allocation */
+          sethvalue2s(L, ra, t);
+        }
+        else {
+          t = luaH_new(L);  /* memory allocation */
+          sethvalue2s(L, ra, t);
           luaH_resize(L, t, c, b);  /* idem */
+        }
+        if (ic != NULL)
+          *ic = tabletag(t) | fb;
         checkGC(L, ra + 1);
         vmbreak;
       }
@@ -1432,7 +1508,7 @@ void luaV_execute (lua_State *L, CallInfo *ci) {
         TValue *rc = KC(i);
         TString *key = tsvalue(rc);  /* key must be a short string */
         setobj2s(L, ra + 1, rb);
-        luaV_fastget(rb, key, s2v(ra), luaH_getshortstr, tag);
+        luaV_fastgetshortstr(rb, key, s2v(ra), ICACHE(), tag);
         if (tagisempty(tag))
           Protect(luaV_finishget(L, rb, rc, ra, tag));
         vmbreak;
@@ -1656,11 +1732,11 @@ void luaV_execute (lua_State *L, CallInfo *ci) {
         vmbreak;
       }
       vmcase(OP_LT) {
-        op_order(L, l_lti, LTnum, lessthanothers);
+        op_order(L, l_lti, luai_numlt, LTnum, lessthanothers);
         vmbreak;
       }
       vmcase(OP_LE) {
-        op_order(L, l_lei, LEnum, lessequalothers);
+        op_order(L, l_lei, luai_numle, LEnum, lessequalothers);
         vmbreak;
       }
       vmcase(OP_EQK) {
@@ -1726,6 +1802,20 @@ void luaV_execute (lua_State *L, CallInfo *ci) {
           L->top.p = ra + b;  /* top signals number of arguments */
         /* else previous instruction set top */
         savepc(ci);  /* in case of errors */
+        if (b != 0 && ttisLclosure(s2v(ra))) {
+          /* try to do the 'precall' here: Lua function with all its
+             parameters, space in the stack, and a free CallInfo */
+          Proto *p = clLvalue(s2v(ra))->p;
+          newci = ci->next;
+          if (b - 1 == p->numparams && newci != NULL &&
+              L->stack_last.p - L->top.p > p->maxstacksize) {
+            luaD_initci(newci, ra, cast_uint(nresults + 1),
+                               ra + 1 + p->maxstacksize);
+            newci->u.l.savedpc = p->code;  /* starting point */
+            L->ci = ci = newci;
+            goto startfunc;
+          }
+        }
         if ((newci = luaD_precall(L, ra, nresults)) == NULL)
           updatetrap(ci);  /* C call; nothing else to be done */
         else {  /* Lua call: run function in this same C frame */
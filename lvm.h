@@ -91,9 +91,27 @@ typedef enum {
   else { luaH_fastgeti(hvalue(t), k, res, tag); }
 
 
+/*
+** Special case of 'luaV_fastget' for short strings, using the inline
+** cache 'hint' (see 'luaH_fastgetshortstr').
+*/
+#define luaV_fastgetshortstr(t,k,res,hint,tag) \
+  if (!ttistable(t)) tag = LUA_VNOTABLE; \
+  else { luaH_fastgetshortstr(hvalue(t), k, res, tag, hint); }
+
+
 #define luaV_fastset(t,k,val,hres,f) \
   (hres = (!ttistable(t) ? HNOTATABLE : f(hvalue(t), k, val)))
 
+/*
+** Special case of 'luaV_fastset' for short strings, using the inline
+** cache 'hint' (see 'luaH_fastsetshortstr').
+*/
+#define luaV_fastsetshortstr(t,k,val,hint,hres) \
+  if (!ttistable(t)) hres = HNOTATABLE; \
+  else { luaH_fastsetshortstr(hvalue(t), k, val, hres, hint); }
+
+
 #define luaV_fastseti(t,k,val,hres) \
   if (!ttistable(t)) hres = HNOTATABLE; \
   else { luaH_fastseti(hvalue(t), k, val, hres); }
@@ -113,6 +131,8 @@ typedef enum {
 
 
 LUAI_FUNC int luaV_equalobj (lua_State *L, const TValue *t1, const TValue *t2);
+LUAI_FUNC int luaV_strcmp (const char *s1, size_t rl1,
+                           const char *s2, size_t rl2);
 LUAI_FUNC int luaV_lessthan (lua_State *L, const TValue *l, const TValue *r);
 LUAI_FUNC int luaV_lessequal (lua_State *L, const TValue *l, const TValue *r);
 LUAI_FUNC int luaV_tonumber_ (const TValue *obj, lua_Number *n);
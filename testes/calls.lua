@@ -513,7 +513,7 @@ do
   local header = {  -- header components
     "\27Lua",               -- signature
     0x55,                   -- version 5.5 (0x55)
-    0,                      -- format
+    1,                      -- format
     "\x19\x93\r\n\x1a\n",   -- a binary string
     string.packsize("i"),   -- size of an int
     -0x5678,                -- an int
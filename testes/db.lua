@@ -1062,5 +1062,21 @@ do   -- tests for 'source' in binary dumps
          debug.getinfo(h).source == '=?')
 end
 
+
+if debug.opcounts then   -- interpreter counting opcodes?
+  print("testing opcode counters")
+  debug.opcounts(true)   -- reset counters
+  local function f (t) local s = 0; for i = 1, 10 do s = s + t.x end; return s end
+  assert(f{x = 1} == 10)
+  local ops, pairs = debug.opcounts()
+  assert(ops.GETFIELD >= 10 and ops.FORLOOP >= 10 and ops.CALL >= 1)
+  assert(pairs["GETFIELD ADD"] >= 10 and pairs["FORLOOP GETFIELD"] >= 9)
+  assert(not pairs["ADD MMBIN"])   -- MMBIN skipped by successful ADD
+  assert(ops.CONCAT == nil)
+  debug.opcounts(true)
+  local ops = debug.opcounts()
+  assert(ops.RETURN0 == nil or ops.RETURN0 <= 2)
+end
+
 print"OK"
 
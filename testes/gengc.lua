@@ -123,6 +123,19 @@ do   -- bug introduced in commit 9cf3299fa
 end
 
 
+do   -- string views keep their parents alive across minor collections
+  local s = string.rep("x", 1000) .. "y"
+  local v = s:sub(2)   -- a view into 's'
+  local old = {}
+  collectgarbage()   -- full collection
+  assert(not T or T.gcage(v) == "old")
+  old[1] = v:sub(2)   -- young view into old 's', from old table
+  s, v = nil
+  for i = 1, 4 do collectgarbage("step") end   -- minor collections
+  assert(#old[1] == 999 and string.find(old[1], "^x+y$"))
+end
+
+
 if T == nil then
   (Message or print)('\n >>> testC not active: \z
                              skipping some generational tests <<<\n')
@@ -156,11 +156,18 @@ local function mp2 (n)
 end
 
 
+-- minimum hash size (zero, a power of 2, or 1.5 times a power of 2) >= n
+local function mhs (n)
+  local mp = mp2(n)
+  return (mp >= 4 and n <= mp * 3 / 4) and mp * 3 / 4 or mp
+end
+
+
 -- testing C library sizes
 do
   local s = 0
   for _ in pairs(math) do s = s + 1 end
-  check(math, 0, mp2(s))
+  check(math, 0, mhs(s))
 end
 
 
@@ -190,11 +197,31 @@ for _, sa in ipairs(sizes) do    -- 'sa' is size of the array part
     T.alloccount();
     collectgarbage("restart")
     assert(#t == sa)
-    check(t, sa, mp2(sh))
+    check(t, sa, mhs(sh))
   end
 end
 
 
+do   -- small records are created with a single allocation
+  local function f (x) return {x = x, y = 2, z = 3} end
+  collectgarbage("stop")
+  f(0)
+  T.alloccount(1)
+  local t = f(1)
+  T.alloccount()
+  collectgarbage("restart")
+  check(t, 0, 3)
+  for i = 1, 10 do t[i .. ""] = i end   -- hash part goes elsewhere
+  assert(t.x == 1 and t.z == 3 and t["10"] == 10)
+  for i = 1, 10 do t[i .. ""] = nil end
+  t.x = nil; t.y = nil; t.z = nil
+  collectgarbage(); t.a = 1   -- force a rehash into a smaller part
+  assert(next(t) == "a" and next(t, "a") == nil)
+  t = nil
+  collectgarbage()
+end
+
+
 -- tests with unknown number of elements
 local a = {}
 for i=1,sizes[#sizes] do a[i] = i end   -- build auxiliary table
@@ -208,6 +235,21 @@ for k in ipairs(sizes) do
 end
 
 
+do   -- tables created by a same instruction get its learned sizes
+  local function f (n)
+    local t = {}
+    local a, h = T.querytab(t)   -- sizes right after creation
+    for i = 1, n do t[i] = i; t[-i] = i end
+    return a, h
+  end
+  local a, h
+  for i = 1, 5 do a, h = f(20) end
+  assert(a == 32 and h == 24)
+  for i = 1, 5 do a, h = f(1000) end
+  assert(a == 0 and h == 0)   -- too large to be learned
+end
+
+
 -- testing tables dynamically built
 local lim = 130
 local a = {}; a[2] = 1; check(a, 2, 0)
@@ -225,7 +267,7 @@ a = {}
 for i = 1,lim do
   a['a'..i] = 1
   assert(#a == 0)
-  check(a, 0, mp2(i))
+  check(a, 0, mhs(i))
 end
 
 
@@ -300,7 +342,7 @@ do
   -- table has only 255 elements, but it got some extra space;
   -- otherwise, almost each delete-insert would rehash the table again.
   assert(countentries(a) == 255)
-  check(a, 0, 512)
+  check(a, 0, 384)
 end
 
 
@@ -415,6 +457,25 @@ end
 assert(n.n == 9000)
 a = nil
 
+do   -- field accesses from one site over tables with different layouts
+  local function get (t) return t.x end
+  local function set (t, v) t.x = v end
+  local ts = {{x = 1}, {y = 2, x = 2}, {a = 1, b = 2, c = 3, x = 3},
+              setmetatable({}, {__index = {x = 4}}), {}}
+  for _ = 1, 3 do
+    for i, t in ipairs(ts) do
+      assert(get(t) == (i < 5 and i or nil))
+    end
+  end
+  local t = {x = 10}
+  for i = 1, 100 do   -- rehashes move 'x' around
+    assert(get(t) == 10); set(t, 10)
+    t["k" .. i] = i
+  end
+  set(t, nil); assert(get(t) == nil and next(t) ~= nil)
+  set(t, 20); assert(get(t) == 20)
+end
+
 do   -- clear global table
   local a = {}
   for n,v in pairs(_G) do a[n]=v end
@@ -512,6 +573,33 @@ end
 assert(n == 5)
 
 
+do   -- interleaved traversals (which share the hint for 'next')
+  local a, b = {}, {}
+  for i = 1, 20 do a["x" .. i] = i; b["y" .. i] = -i end
+  for i = 1, 10 do b[i * 1.5] = i end   -- different layout for 'b'
+  local sa, sb, n = 0, 0, 0
+  local ka, kb, va, vb
+  kb, vb = next(b)
+  ka, va = next(a)
+  repeat
+    if ka then
+      sa = sa + va; a[ka] = va * 2; n = n + 1   -- assign to existing field
+      ka, va = next(a, ka)
+    end
+    if kb then sb = sb + vb; kb, vb = next(b, kb) end
+  until not ka and not kb
+  assert(n == 20 and sa == 210 and sb == -210 + 55)
+  for k, v in pairs(a) do   -- nested traversals of the same table
+    local c = 0
+    for k1 in pairs(a) do c = c + 1 end
+    assert(c == 20 and v == 2 * tonumber(string.sub(k, 2)))
+  end
+  -- a key in the hinted position of another table
+  assert(next(a, next(a)) ~= next(a))
+  checkerror("invalid key", next, a, next(b))
+end
+
+
 do
   print("testing next x GC of deleted keys")
   -- bug in 5.4.1
@@ -271,6 +271,83 @@ if not _soft then
   assert(not pcall(string.gsub, a, 'b'))
 end
 
+do  -- captures at the end of long subjects
+  local a, b = string.rep("a", 1000), string.rep("b", 1000)
+  local s = a .. "=" .. b
+  local k, v = s:match("^(%a+)=(.*)$")
+  local w
+  for x in s:gmatch("%a+") do w = x end
+  local _, n = string.gsub(s, "=(.*)", function (x) assert(x == v) end)
+  assert(n == 1)
+  s = nil
+  collectgarbage()
+  assert(k == a and v == b and w == b)
+end
+
+do  -- first characters of matches (and their cache)
+  local s = "key1=val1; key22 = [x]; (k3)=v3"
+  local pats = {"%w+=", "(%d+)", "%[(.-)%]", "%b()", "=%s*(%w+)",
+                "[;=]", "[^%w%s]+", "()k", "(k)%d", "v(%d)$", "(%a+)"}
+  local res = {}
+  for i = 1, 3 do   -- more patterns than cache entries, in a loop
+    for j, p in ipairs(pats) do
+      local r = {string.find(s, p)}
+      r[#r + 1] = select(2, string.gsub(s, p, "%0"))
+      for c in string.gmatch(s, p) do r[#r + 1] = c end
+      r = table.concat(r, ",")
+      assert(res[j] == nil or res[j] == r)
+      res[j] = r
+    end
+  end
+  assert(res[2] == "4,4,1,5,1,1,22,3,3" and res[4] == "25,28,1,(k3)")
+  -- cache entries replaced while a match is running
+  assert(string.gsub("a.b.c", "%a", function (c)
+    for _, p in ipairs(pats) do string.find(s, p) end
+    return c .. c
+  end) == "aa.bb.cc")
+  assert(string.gsub("a.b.c", "%.", "/") == "a/b/c")
+  assert(string.gsub("abc", "^b", "x") == "abc")
+  assert(string.find("abc", "^c") == nil)
+  assert(string.match("xay", "(%a)", 2) == "a")
+  assert(not string.find("aaa", "b+") and not string.match("", "%d"))
+  local p = "x" .. string.rep("y", 100)   -- long pattern (not interned)
+  assert(string.find(p .. "z", p) == 1 and string.find("a" .. p, p) == 2)
+end
+
+do  -- more patterns with sets than cache entries
+  local s = "a1b2c3d4e5f6g7h8i9j0;A1"
+  local pats = {}
+  for i = 1, 10 do
+    local l = string.sub("abcdefghij", i, i)
+    pats[i] = "[" .. l .. string.upper(l) .. "](%d)"
+  end
+  local function check (i)
+    local d = tostring(i % 10)
+    local n = (i == 1) and 2 or 1
+    assert(string.match(s, pats[i]) == d)
+    assert(string.find(s, pats[i]) == 2 * i - 1)
+    assert(select(2, string.gsub(s, pats[i], "")) == n)
+    local t = {}
+    for c in string.gmatch(s, pats[i]) do t[#t + 1] = c end
+    assert(#t == n and t[1] == d)
+  end
+  for _ = 1, 3 do   -- each use evicts an entry needed later
+    for i = 1, #pats do check(i) end
+    for i = #pats, 1, -1 do check(i) end
+  end
+  -- entries evicted (and their patterns collected) during a match
+  local r = string.gsub(s, "[%l](%d)", function (d)
+    for i = 1, #pats do check(i) end
+    for i = 1, 10 do   -- new patterns can reuse addresses of old ones
+      local p = string.rep("[^%d]", 1, i) .. string.rep("x", i)
+      assert(not string.find(s, p))
+    end
+    collectgarbage()
+    return d
+  end)
+  assert(r == "1234567890;A1")
+end
+
 -- recursive nest of gsubs
 local function rev (s)
   return string.gsub(s, "(.)(.+)", function (c,s1) return rev(s1)..c end)
@@ -222,6 +222,44 @@ do
   checkmove(minI + 1, -1, 1, minI + 1, 1)  -- non overlapping
 end
 
+do   -- block moves inside array parts
+  local function check (t, n, ...)
+    local e = {...}
+    for i = 1, n do assert(t[i] == e[i]) end
+  end
+  local a = table.create(6)
+  for i = 1, 5 do a[i] = i * 10 end
+  table.insert(a, 1, 0); check(a, 6, 0, 10, 20, 30, 40, 50)
+  table.insert(a, 3, 15); check(a, 7, 0, 10, 15, 20, 30, 40, 50)
+  assert(table.remove(a, 1) == 0); check(a, 7, 10, 15, 20, 30, 40, 50, nil)
+  assert(table.remove(a, 2) == 15); check(a, 6, 10, 20, 30, 40, 50, nil)
+  a[3] = nil   -- holes move too
+  table.move(a, 1, 5, 2); check(a, 6, 10, 10, 20, nil, 40, 50)
+  table.move(a, 2, 6, 1); check(a, 6, 10, 20, nil, 40, 50, 50)
+  local b = table.create(10)
+  table.move(a, 1, 6, 3, b); check(b, 8, nil, nil, 10, 20, nil, 40, 50, 50)
+  table.move(a, 1, 6, 8, b)   -- partially outside the array part
+  check(b, 13, nil, nil, 10, 20, nil, 40, 50, 10, 20, nil, 40, 50, 50)
+
+  -- '__index' and '__newindex' must still be called
+  local log = {}
+  a = setmetatable(table.create(5), {__newindex = function (t, k, v)
+                                                     log[#log + 1] = k
+                                                     rawset(t, k, v)
+                                                   end})
+  a[1] = 1; a[2] = 2; a[3] = nil; a[4] = 4
+  log = {}
+  table.move(a, 1, 4, 2)
+  assert(#log == 2 and log[1] == 5 and log[2] == 3)
+  check(a, 5, 1, 1, 2, nil, 4)
+
+  -- a queue
+  a = {}
+  for i = 1, 1000 do a[i] = i end
+  for i = 1, 1000 do assert(table.remove(a, 1) == i) end
+  assert(#a == 0 and next(a) == nil)
+end
+
 checkerror("too many", table.move, {}, 0, maxI, 1)
 checkerror("too many", table.move, {}, -1, maxI - 1, 1)
 checkerror("too many", table.move, {}, minI, -1, 1)
@@ -344,6 +382,52 @@ table.sort(AA, function (x, y)
 
 _G.AA = nil
 
+do   -- homogeneous arrays (native fast path) and their fallbacks
+  local function checksorted (t, n)
+    assert(#t == n)
+    for i = 2, n do assert(not (t[i] < t[i - 1])) end
+  end
+
+  local t = {}
+  for i = 1, 5000 do t[i] = math.random(-1000, 1000) end
+  table.sort(t); checksorted(t, 5000)
+  t = {}
+  for i = 1, 5000 do t[i] = math.random() - 0.5 end
+  table.sort(t); checksorted(t, 5000)
+  t = {}
+  for i = 1, 3000 do t[i] = tostring(math.random(1000)) end
+  table.sort(t); checksorted(t, 3000)
+
+  t = {3, 1.5, -2, 2^53, math.mininteger, 0.5, 7}   -- mixed numbers
+  table.sort(t); checksorted(t, 7)
+  assert(t[1] == math.mininteger and math.type(t[1]) == "integer")
+
+  t = {"a\0b", "a", "a\0a", "", "\0", "b"}   -- embedded zeros
+  table.sort(t)
+  assert(t[1] == "" and t[2] == "\0" and t[3] == "a" and
+         t[4] == "a\0a" and t[5] == "a\0b" and t[6] == "b")
+
+  t = {0.0, -0.0, 1.0, -1.0}
+  table.sort(t); checksorted(t, 4)
+  assert(t[1] == -1.0 and t[2] == 0 and t[3] == 0 and t[4] == 1.0)
+
+  t = {3.0, 0/0, 1.0}   -- NaN: falls back to the generic sort
+  table.sort(t)   -- result order is unspecified, but must not fail
+  assert(#t == 3)
+
+  -- tables with metatables go through the metamethods
+  local log, back = {}, {5, 3, 9, 1, 7, 2, 8, 4, 6}
+  local p = setmetatable({}, {__index = back,
+                              __newindex = function (_, k, v)
+                                             log[#log + 1] = k; back[k] = v
+                                           end,
+                              __len = function () return #back end})
+  table.sort(p)
+  for i = 1, 9 do assert(back[i] == i) end
+  assert(#log > 0)   -- writes went through '__newindex'
+end
+
+
 local tt = {__lt = function (a,b) return a.val < b.val end}
 a = {}
 for i=1,10 do  a[i] = {val=math.random(100)}; setmetatable(a[i], tt); end
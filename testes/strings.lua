@@ -54,6 +54,23 @@ assert(string.sub("123456789", mini, mini) == "")
 assert(string.sub("\000123456789",3,5) == "234")
 assert(("\000123456789"):sub(8) == "789")
 
+do  -- long suffixes share the contents of their strings
+  local s = string.rep("0123456789", 1000)
+  local t = {}
+  collectgarbage()
+  local m = collectgarbage("count")
+  for i = 1, 500 do t[i] = s:sub(i) end
+  assert(collectgarbage("count") - m < 1000)   -- copies would need ~5MB
+  s = nil
+  collectgarbage()
+  for i = 1, 500 do assert(#t[i] == 10001 - i) end
+  local s1 = "9" .. string.rep("0123456789", 950)
+  assert(t[500] == s1 and t[500]:sub(2) == s1:sub(2))
+  assert(t[1]:sub(-10) == "0123456789" and t[1]:sub(3, 4) == "23")
+  local k = {[t[490]] = true}
+  assert(k[string.rep("9012345678", 951) .. "9"])
+end
+
 -- testing string.find
 assert(string.find("123456789", "345") == 3)
 local a,b = string.find("123456789", "345")